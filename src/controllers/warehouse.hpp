@@ -1,23 +1,82 @@
 #ifndef WAREHOUSE_CONTROLLER_HEADER
 #define WAREHOUSE_CONTROLLER_HEADER
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "models/article.hpp"
 #include "models/product.hpp"
+#include "models/shared_inventory.hpp"
+#include "io/watcher.hpp"
+#include "simulation/simulator.hpp"
+#include "timers/wheel.hpp"
 
 namespace controllers {
 	class warehouse {
 		private:
+			struct reservation {
+				std::string product;
+				models::list_of_articles articles;
+				int slot;
+			};
+			struct criteria {
+				bool available = false;
+				int below = std::numeric_limits<int>::max();
+				std::string prefix;
+				bool by_availability = false;
+				bool descending = false;
+				std::size_t limit = std::numeric_limits<std::size_t>::max();
+				std::string after;
+			};
+			typedef std::pair<const std::string, int> entry;
 			models::product* product;
 			models::article* article;
+			models::shared_inventory* shared;
+			io::watcher* watcher;
+			std::unordered_map<unsigned long, reservation> holds;
+			timers::wheel<unsigned long> expiries;
+			unsigned long last_hold;
+			std::chrono::steady_clock::time_point started;
 			void dump(std::ostream&, const std::string&);
+			criteria get_criteria(std::stringstream&);
+			void list_by_name(const std::map<std::string, int>&, const criteria&);
+			void list_by_availability(const std::map<std::string, int>&, const criteria&);
+			bool take(const models::list_of_articles&);
+			bool reserve(reservation&);
+			void give_back(const reservation&);
+			void adjust(const models::list_of_articles&, int);
+			void propagate(int, int);
+			void expire();
+			void catch_up();
+			void reload();
+			void release(unsigned long);
+			unsigned long get_hold_id(std::stringstream&);
 		public:
+			struct settings {
+				std::string shared;
+				std::uint32_t holds = 65536;
+				std::string inventory = "inventory";
+				std::string catalog = "products";
+			};
+
 			warehouse();
+			warehouse(const settings&);
 			void list(std::stringstream&);
 			void sell(std::stringstream&);
+			void hold(std::stringstream&);
+			void confirm(std::stringstream&);
+			void release(std::stringstream&);
+			void reload(std::stringstream&);
+			void simulate(std::stringstream&);
+			void watch();
 			void help(std::stringstream&);
 			void exit(std::stringstream&);
 	};
@@ -25,15 +84,136 @@ namespace controllers {
 
 using controllers::warehouse;
 
-warehouse::warehouse() {
-	article = new models::article();
-	product = new models::product(article);
+warehouse::warehouse(): warehouse(settings()) { }
+
+warehouse::warehouse(const settings& configuration):
+	shared(NULL), watcher(NULL), last_hold(0), started(std::chrono::steady_clock::now()) {
+
+	article = new models::article(configuration.inventory);
+	product = new models::product(article, configuration.catalog);
+	if (!configuration.shared.empty()) {
+		shared = new models::shared_inventory(configuration.shared, article, product, configuration.holds);
+	}
 }
 
 void warehouse::list(std::stringstream& arguments) {
-	for (auto& name: product->get_all_keys()) {
-		product->read(name);
-		std::cout << name << ": " << product->get_availability() << std::endl;
+	criteria filter = get_criteria(arguments);
+	catch_up();
+	const std::map<std::string, int>& availabilities = shared ? shared->get_availabilities() : product->get_availabilities();
+	if (filter.by_availability) {
+		list_by_availability(availabilities, filter);
+	} else {
+		list_by_name(availabilities, filter);
+	}
+	std::cout.flush();
+}
+
+warehouse::criteria warehouse::get_criteria(std::stringstream& arguments) {
+	criteria filter;
+	std::string option;
+	while (arguments >> option) {
+		if (option == "available") {
+			filter.available = true;
+		} else if (option == "below") {
+			arguments >> filter.below;
+		} else if (option == "prefix") {
+			arguments >> std::quoted(filter.prefix);
+		} else if (option == "by") {
+			arguments >> option;
+			if (option != "name" && option != "availability") {
+				throw std::invalid_argument("Products can only be listed by name or availability!");
+			}
+			filter.by_availability = option == "availability";
+		} else if (option == "desc") {
+			filter.descending = true;
+		} else if (option == "limit") {
+			arguments >> filter.limit;
+			if (!filter.limit) {
+				throw std::invalid_argument("The limit of products to list must be positive!");
+			}
+		} else if (option == "after") {
+			arguments >> std::quoted(filter.after);
+		} else {
+			throw std::invalid_argument("Unrecognized list option '" + option + "'!");
+		}
+		if (arguments.fail()) {
+			throw std::invalid_argument("Missing or invalid value for list option '" + option + "'!");
+		}
+	}
+	if (filter.descending && !filter.by_availability) {
+		throw std::invalid_argument("Only the listing by availability can be in descending order!");
+	}
+	return filter;
+}
+
+// Availabilities are kept sorted by name, so the products are streamed straight from them.
+void warehouse::list_by_name(const std::map<std::string, int>& availabilities, const criteria& filter) {
+	auto current = availabilities.lower_bound(filter.prefix);
+	if (!filter.after.empty() && filter.after >= filter.prefix) {
+		current = availabilities.upper_bound(filter.after);
+	}
+
+	std::size_t shown = 0;
+	std::string last;
+	for (; current != availabilities.end() && shown < filter.limit; ++current) {
+		auto& [name, availability] = *current;
+		if (name.compare(0, filter.prefix.size(), filter.prefix)) break;
+		if (filter.available && availability <= 0) continue;
+		if (availability >= filter.below) continue;
+		std::cout << name << ": " << availability << '\n';
+		last = name;
+		++shown;
+	}
+
+	if (shown && shown == filter.limit) {
+		std::cout << "-- after " << std::quoted(last) << '\n';
+	}
+}
+
+// Only the first products of the requested page are kept in a bounded heap, instead of sorting all.
+void warehouse::list_by_availability(const std::map<std::string, int>& availabilities, const criteria& filter) {
+	auto before = [&filter](const entry* left, const entry* right) {
+		if (left->second != right->second) {
+			return filter.descending ? left->second > right->second : left->second < right->second;
+		}
+		return left->first < right->first;
+	};
+
+	bool paging = !filter.after.empty();
+	std::size_t separator = filter.after.find(':');
+	if (paging && separator == std::string::npos) {
+		throw std::invalid_argument("Invalid cursor, expected '<availability>:<product name>'!");
+	}
+	const entry cursor(
+		paging ? filter.after.substr(separator + 1) : "",
+		paging ? std::stoi(filter.after.substr(0, separator)) : 0
+	);
+
+	std::vector<const entry*> page;
+	for (auto current = availabilities.lower_bound(filter.prefix); current != availabilities.end(); ++current) {
+		const entry& candidate = *current;
+		if (candidate.first.compare(0, filter.prefix.size(), filter.prefix)) break;
+		if (filter.available && candidate.second <= 0) continue;
+		if (candidate.second >= filter.below) continue;
+		if (paging && !before(&cursor, &candidate)) continue;
+		if (page.size() == filter.limit && !before(&candidate, page.front())) continue;
+		page.push_back(&candidate);
+		std::push_heap(page.begin(), page.end(), before);
+		if (page.size() > filter.limit) {
+			std::pop_heap(page.begin(), page.end(), before);
+			page.pop_back();
+		}
+	}
+	std::sort_heap(page.begin(), page.end(), before);
+
+	for (auto& current: page) {
+		std::cout << current->first << ": " << current->second << '\n';
+	}
+
+	if (!page.empty() && page.size() == filter.limit) {
+		std::stringstream next;
+		next << page.back()->second << ':' << page.back()->first;
+		std::cout << "-- after " << std::quoted(next.str()) << '\n';
 	}
 }
 
@@ -41,26 +221,226 @@ void warehouse::sell(std::stringstream& arguments) {
 	std::string name;
 	std::getline(arguments, name);
 	std::clog << "Trying to sell a '" << name << "'..." << std::endl;
+	catch_up();
 
 	if (!product->read(name)) {
 		throw std::invalid_argument("Product doesn't exists!");
 	}
 
-	if (!product->is_available()) {
+	if (!take(product->get_bill())) {
 		throw std::invalid_argument("Product is not available!");
 	}
 
-	for (auto& [article_id, amount]: product->get_requirements()) {
+	std::clog << "We just sold a '" << name << "', yaaay!! :)" << std::endl;
+}
+
+void warehouse::hold(std::stringstream& arguments) {
+	std::string name;
+	std::getline(arguments, name);
+	std::size_t separator = name.find_last_of(' ');
+	if (separator == std::string::npos) {
+		throw std::invalid_argument("Expected a product name and a time to live in seconds!");
+	}
+	int ttl = std::stoi(name.substr(separator + 1));
+	name.erase(separator);
+	if (ttl <= 0) {
+		throw std::invalid_argument("Time to live must be a positive number of seconds!");
+	}
+	std::clog << "Trying to hold a '" << name << "' for " << ttl << " seconds..." << std::endl;
+	catch_up();
+
+	if (!product->read(name)) {
+		throw std::invalid_argument("Product doesn't exists!");
+	}
+
+	reservation held = {name, product->get_bill(), -1};
+	if (!reserve(held)) {
+		throw std::invalid_argument("Product is not available!");
+	}
+
+	unsigned long id = ++last_hold;
+	holds[id] = held;
+	// Rounded up, since expiries only advance on whole seconds and a hold must last its whole time to live.
+	auto now = std::chrono::steady_clock::now() - started;
+	expiries.schedule(id, std::chrono::ceil<std::chrono::seconds>(now).count() + ttl);
+
+	std::cout << "Hold " << id << ": '" << name << "' for " << ttl << " seconds." << std::endl;
+}
+
+void warehouse::confirm(std::stringstream& arguments) {
+	unsigned long id = get_hold_id(arguments);
+	if (shared) shared->confirm(holds[id].slot);
+	std::clog << "We just sold a '" << holds[id].product << "' from hold " << id << ", yaaay!! :)" << std::endl;
+	holds.erase(id);
+}
+
+void warehouse::release(std::stringstream& arguments) {
+	release(get_hold_id(arguments));
+}
+
+unsigned long warehouse::get_hold_id(std::stringstream& arguments) {
+	unsigned long id = 0;
+	arguments >> id;
+	catch_up();
+	if (!holds.count(id)) {
+		throw std::invalid_argument("Hold doesn't exists or has expired!");
+	}
+	return id;
+}
+
+void warehouse::release(unsigned long id) {
+	std::clog << "Releasing hold " << id << " of a '" << holds[id].product << "'..." << std::endl;
+	give_back(holds[id]);
+	holds.erase(id);
+}
+
+void warehouse::reload(std::stringstream& arguments) {
+	catch_up();
+	reload();
+}
+
+void warehouse::simulate(std::stringstream& arguments) {
+	simulation::simulator::settings settings;
+	std::string option;
+	while (arguments >> option) {
+		if (option == "scenarios") {
+			arguments >> settings.scenarios;
+		} else if (option == "orders") {
+			arguments >> settings.orders;
+		} else if (option == "threads") {
+			arguments >> settings.threads;
+		} else if (option == "seed") {
+			arguments >> settings.seed;
+		} else if (option == "mix") {
+			std::string name;
+			double weight = 0;
+			arguments >> std::quoted(name) >> weight;
+			if (weight <= 0) {
+				throw std::invalid_argument("Weight of product '" + name + "' in the mix must be positive!");
+			}
+			settings.mix[name] = weight;
+		} else {
+			throw std::invalid_argument("Unrecognized simulate option '" + option + "'!");
+		}
+		if (arguments.fail()) {
+			throw std::invalid_argument("Missing or invalid value for simulate option '" + option + "'!");
+		}
+	}
+	catch_up();
+
+	std::vector<std::string> names;
+	std::vector<models::list_of_articles> bills;
+	std::vector<int> availabilities;
+	for (auto& [name, availability]: shared ? shared->get_availabilities() : product->get_availabilities()) {
+		product->read(name);
+		names.push_back(name);
+		bills.push_back(product->get_bill());
+		availabilities.push_back(availability);
+	}
+	std::map<int, int> stocks;
+	for (auto& id: article->get_all_keys()) {
+		article->read(id);
+		stocks[id] = shared ? shared->get_stock(id) : article->get_stock();
+	}
+
+	std::clog << "Simulating " << settings.scenarios << " scenarios of " << settings.orders << " orders..." << std::endl;
+	simulation::simulator simulator(names, bills, stocks, availabilities);
+	simulator.run(settings);
+	simulator.report(std::cout);
+}
+
+void warehouse::watch() {
+	if (shared) {
+		throw std::invalid_argument("Catalog can't be reloaded on a shared inventory!");
+	}
+	watcher = new io::watcher(product->get_filename());
+}
+
+void warehouse::reload() {
+	if (shared) {
+		throw std::invalid_argument("Catalog can't be reloaded on a shared inventory!");
+	}
+	std::clog << "Reloading catalog from '" << product->get_filename() << "'..." << std::endl;
+	models::product::changes changes = product->reload();
+	std::clog << "Catalog reloaded: "
+		<< changes.added.size() << " added, "
+		<< changes.removed.size() << " removed, "
+		<< changes.changed.size() << " changed."
+	<< std::endl;
+}
+
+// Catches up with what happened since the previous request: expired holds and catalog changes.
+void warehouse::catch_up() {
+	expire();
+	if (watcher && watcher->changed()) {
+		try {
+			reload();
+		} catch(const std::exception& error) {
+			std::cerr << error.what() << std::endl;
+		}
+	}
+}
+
+void warehouse::expire() {
+	auto now = std::chrono::steady_clock::now() - started;
+	expiries.advance(std::chrono::duration_cast<std::chrono::seconds>(now).count(), [this](const unsigned long& id) {
+		// Confirmed or released holds are not unscheduled, they are just skipped here.
+		if (holds.count(id)) release(id);
+	});
+}
+
+// Takes the articles of the product just read out of the stock, as long as it's available.
+// simulator::simulate follows the same rules on flattened bills, so changes here must be made there too.
+bool warehouse::take(const models::list_of_articles& bill) {
+	if (shared) return shared->adjust(bill, -1);
+	if (!product->is_available()) return false;
+	adjust(bill, -1);
+	return true;
+}
+
+// A shared inventory keeps the hold itself, so its articles go back even if this process dies first.
+bool warehouse::reserve(reservation& held) {
+	if (!shared) return take(held.articles);
+	held.slot = shared->hold(held.product);
+	return held.slot >= 0;
+}
+
+void warehouse::give_back(const reservation& held) {
+	if (shared) {
+		shared->release(held.slot);
+	} else {
+		adjust(held.articles, +1);
+	}
+}
+
+void warehouse::adjust(const models::list_of_articles& requirements, int direction) {
+	for (auto& [article_id, amount]: requirements) {
 		article->read(article_id);
-		article->set_stock(article->get_stock() - amount);
+		article->set_stock(article->get_stock() + direction * amount);
 		article->write();
-		for ( auto& name: article->get_subscribers() ) {
-			product->read(name);
+		propagate(article_id, direction);
+	}
+}
+
+// Products made from the article are updated first, then the products made from those, and so on.
+void warehouse::propagate(int article_id, int direction) {
+	hashset<std::string> subscribers = article->get_subscribers();
+	std::vector<std::string> pending(subscribers.begin(), subscribers.end());
+	hashset<std::string> updated;
+	while (!pending.empty()) {
+		std::string name = pending.back();
+		pending.pop_back();
+		if (!updated.insert(name).second) continue;
+		product->read(name);
+		if (direction < 0) {
 			product->update_availability(article_id);
+		} else {
+			product->refresh_availability();
+		}
+		for ( auto& dependant: product->get_dependants() ) {
+			pending.push_back(dependant);
 		}
 	}
-
-	std::clog << "We just sold a '" << name << "', yaaay!! :)" << std::endl;
 }
 
 void warehouse::dump(std::ostream& output, const std::string& filename) {
@@ -78,6 +458,17 @@ void warehouse::help(std::stringstream& arguments) {
 }
 
 void warehouse::exit(std::stringstream& arguments) {
+	// Pending payments can't be confirmed after exit, so their articles go back to the stock.
+	while (!holds.empty()) {
+		release(holds.begin()->first);
+	}
+	if (shared) {
+		for (auto& id: article->get_all_keys()) {
+			article->read(id);
+			article->set_stock(shared->get_stock(id));
+			article->write();
+		}
+	}
 	article->commit();
 	dump(std::clog, "data/inventory.json");
 	std::cout << "Bye! :)" << std::endl;
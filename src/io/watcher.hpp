@@ -0,0 +1,63 @@
+#ifndef IO_WATCHER_HEADER
+#define IO_WATCHER_HEADER
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace io {
+	/**
+	 *  Watches a file for changes through inotify without blocking, so the application can check for
+	 *  them between requests. The whole directory is watched because most editors replace the file
+	 *  by a new one instead of writing over it.
+	 */
+	class watcher {
+	public:
+		watcher(const std::string&);
+		~watcher();
+		bool changed();
+
+	private:
+		int descriptor;
+		std::string directory;
+		std::string file;
+	};
+}
+
+using io::watcher;
+
+watcher::watcher(const std::string& filename) {
+	std::size_t separator = filename.find_last_of('/');
+	directory = separator == std::string::npos ? "." : filename.substr(0, separator);
+	file = separator == std::string::npos ? filename : filename.substr(separator + 1);
+
+	descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (descriptor < 0 || inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		std::string reason(std::strerror(errno));
+		if (descriptor >= 0) close(descriptor);
+		throw std::runtime_error("Unable to watch '" + filename + "': " + reason);
+	}
+}
+
+watcher::~watcher() { close(descriptor); }
+
+// Drains every pending event, several of them usually come from a single save.
+bool watcher::changed() {
+	alignas(inotify_event) char buffer[4096];
+	bool modified = false;
+	ssize_t length;
+	while ((length = ::read(descriptor, buffer, sizeof(buffer))) > 0) {
+		for (char* position = buffer; position < buffer + length; ) {
+			inotify_event* event = reinterpret_cast<inotify_event*>(position);
+			if (event->len && file == event->name) modified = true;
+			position += sizeof(inotify_event) + event->len;
+		}
+	}
+	return modified;
+}
+
+#endif // IO_WATCHER_HEADER
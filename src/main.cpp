@@ -1,58 +1,159 @@
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <unordered_map>
 
 #include "main.hpp"
 #include "controllers/warehouse.hpp"
+#include "trace/recorder.hpp"
+#include "trace/replayer.hpp"
 
 using command_map = std::unordered_map<std::string, int>;
+using option_map = std::unordered_map<std::string, std::string>;
 
 enum REQUEST_TYPE {
 	NONE = 0,
 	LIST = 1,
 	SELL = 2,
 	HELP = 3,
-	EXIT = 4
+	EXIT = 4,
+	HOLD = 5,
+	CONFIRM = 6,
+	RELEASE = 7,
+	RELOAD = 8,
+	SIMULATE = 9
 };
 
 const command_map commands{
 	{"list", LIST},
 	{"sell", SELL},
+	{"hold", HOLD},
+	{"confirm", CONFIRM},
+	{"release", RELEASE},
+	{"reload", RELOAD},
+	{"simulate", SIMULATE},
 	{"help", HELP},
 	{"exit", EXIT},
 };
 
+option_map get_options(int argc, char const *argv[]) {
+	option_map options;
+	for (int index = 1; index < argc; ++index) {
+		std::string name(argv[index]);
+		bool has_value = index + 1 < argc && std::string(argv[index + 1]).rfind("--", 0) != 0;
+		options[name] = has_value ? argv[++index] : "";
+	}
+	return options;
+}
+
+int get_request(std::stringstream& command_line) {
+	std::string command_name;
+	command_line >> command_name;
+	if (!command_name.size()) return NONE;
+	command_line.ignore();
+	command_map::const_iterator request = commands.find(command_name);
+	if (request == commands.end()) {
+		throw std::invalid_argument("Error: unrecognized request, please try again.");
+	}
+	return request->second;
+}
+
+void execute(controllers::warehouse& warehouse, int user_request, std::stringstream& command_line) {
+	switch (user_request) {
+		case LIST: warehouse.list(command_line); break;
+		case SELL: warehouse.sell(command_line); break;
+		case HOLD: warehouse.hold(command_line); break;
+		case CONFIRM: warehouse.confirm(command_line); break;
+		case RELEASE: warehouse.release(command_line); break;
+		case RELOAD: warehouse.reload(command_line); break;
+		case SIMULATE: warehouse.simulate(command_line); break;
+		case HELP: warehouse.help(command_line); break;
+		case EXIT: warehouse.exit(command_line); break;
+	}
+}
+
+int replay(controllers::warehouse& warehouse, const option_map& options) {
+	trace::replayer replayer(options.at("--replay"));
+	double speed = 1;
+	unsigned clients = 1;
+	if (options.count("--speed")) {
+		const std::string& value = options.at("--speed");
+		speed = value == "max" ? 0 : std::stod(value);
+	}
+	if (options.count("--clients")) {
+		clients = std::stoul(options.at("--clients"));
+	}
+
+	// Requests' own output is not part of the measurement, so it's discarded while replaying.
+	auto old_output_buffer = std::cout.rdbuf(nullptr);
+	auto old_log_buffer = std::clog.rdbuf(nullptr);
+	replayer.run([&warehouse](const std::string& user_input) {
+		std::stringstream command_line(user_input);
+		int user_request = get_request(command_line);
+		if (user_request != EXIT) execute(warehouse, user_request, command_line);
+	}, speed, clients);
+	std::clog.rdbuf(old_log_buffer);
+	std::cout.rdbuf(old_output_buffer);
+
+	replayer.report(std::cout);
+	return EXIT_SUCCESS;
+}
+
 int main(int argc, char const *argv[]) {
 	std::ios_base::sync_with_stdio(false);
 	bool silent_mode = argc > 1;
+	option_map options = get_options(argc, argv);
 	std::string prompt(silent_mode ? "" : "Please type a request: ");
 	int user_request = NONE;
 	std::string user_input;
-	controllers::warehouse warehouse;
+	std::unique_ptr<controllers::warehouse> warehouse;
+	std::unique_ptr<trace::recorder> recorder;
+	try {
+		controllers::warehouse::settings settings;
+		if (options.count("--shared")) {
+			if (options["--shared"].empty()) {
+				throw std::invalid_argument("A name is required for the shared inventory!");
+			}
+			settings.shared = options["--shared"];
+		}
+		if (options.count("--holds")) {
+			settings.holds = std::stoul(options["--holds"]);
+		}
+		warehouse.reset(new controllers::warehouse(settings));
+		if (options.count("--watch")) {
+			warehouse->watch();
+		}
+		if (options.count("--replay")) {
+			return replay(*warehouse, options);
+		}
+		if (options.count("--record")) {
+			recorder.reset(new trace::recorder(options["--record"]));
+		}
+	} catch(const std::exception& error) {
+		std::cerr << error.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
 	do {
 		std::cout << prompt;
 		std::getline(std::cin, user_input);
 		std::stringstream command_line(user_input);
-		std::string command_name;
-		command_line >> command_name;
-		if (!command_name.size()) continue;
-		command_line.ignore();
-		command_map::const_iterator request = commands.find(command_name);
-		user_request = request == commands.end() ? NONE : request->second;
+		trace::outcome result = trace::SUCCESS;
+		trace::clock::time_point started = trace::clock::now();
 		try {
-			switch (user_request) {
-				case LIST: warehouse.list(command_line); break;
-				case SELL: warehouse.sell(command_line); break;
-				case HELP: warehouse.help(command_line); break;
-				case EXIT: warehouse.exit(command_line); break;
-				default:
-					throw std::invalid_argument("Error: unrecognized request, please try again.");
-			}
+			user_request = get_request(command_line);
+			if (user_request == NONE) continue;
+			execute(*warehouse, user_request, command_line);
 		} catch(const std::exception& error) {
+			result = trace::FAILURE;
 			std::cerr << error.what() << std::endl;
 		}
+		if (recorder) {
+			recorder->record(user_input, started, trace::clock::now(), result);
+		}
 	} while(user_request != EXIT);
 	return EXIT_SUCCESS;
 }
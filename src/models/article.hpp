@@ -18,7 +18,7 @@ using hashmap = std::unordered_map<Key, Value>;
 namespace models {
 	class article: public model<int> {
 	public:
-		article();
+		article(const std::string& = "inventory");
 		inline primary_key& get_primary_key() override { return id; }
 		int get_id();
 		std::string get_name();
@@ -26,6 +26,7 @@ namespace models {
 		void set_name(const std::string&);
 		void set_stock(int);
 		bool subscribe(int, const std::string&);
+		bool unsubscribe(int, const std::string&);
 		hashset<std::string> get_subscribers();
 
 	protected:
@@ -43,8 +44,8 @@ namespace models {
 using models::model;
 using models::article;
 
-article::article():
-	model("inventory"), id("art_id"),
+article::article(const std::string& source):
+	model(source, "inventory"), id("art_id"),
 	name("name"), stock("stock") {
 
 	fetch();
@@ -75,4 +76,8 @@ bool article::subscribe(int id, const std::string& product_name) {
 	return subscribers[id].insert(product_name).second;
 }
 
+bool article::unsubscribe(int id, const std::string& product_name) {
+	return subscribers[id].erase(product_name);
+}
+
 #endif // ARTICLE_HEADER
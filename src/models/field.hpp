@@ -78,6 +78,14 @@ namespace models {
 		 */
 		field(const std::string&, const Getter&, const Setter&);
 
+		/**
+		 *  Copy constructor which binds the default getter and setter (if used) to the new field, so
+		 *  reading through the copy doesn't change the internal value of the original one.
+		 *
+		 *  @param const field<Type>& Reference to the field to copy.
+		 */
+		field(const field<Type>&);
+
 		/**
 		 *  Default getter to extract a value from JSON node and put in the internal value. For this
 		 *  particular project de default behaviour is take an string from the JSON node and parse
@@ -164,6 +172,11 @@ namespace models {
 		 *  Final (custom or default) setter.
 		 */
 		Setter setter;
+
+		/**
+		 *  Whether the getter and setter are the default ones, bound to this very field.
+		 */
+		bool defaults;
 	};
 }
 
@@ -188,12 +201,20 @@ std::istream& operator>>(std::istream& input, field<Type>& instance) {
 
 template<typename Type>
 field<Type>::field(const std::string& key, const Getter& custom_getter, const Setter& custom_setter):
-key(key), getter(custom_getter), setter(custom_setter) { };
+key(key), getter(custom_getter), setter(custom_setter), defaults(false) { };
 
 template<typename Type>
 field<Type>::field(const std::string& key): key(key),
 getter(std::bind(&field<Type>::default_getter, this, std::placeholders::_1)),
-setter(std::bind(&field<Type>::default_setter, this, std::placeholders::_1, std::placeholders::_2))
+setter(std::bind(&field<Type>::default_setter, this, std::placeholders::_1, std::placeholders::_2)),
+defaults(true)
+{ }
+
+template<typename Type>
+field<Type>::field(const field<Type>& other): key(other.key), value(other.value),
+getter(other.defaults ? Getter(std::bind(&field<Type>::default_getter, this, std::placeholders::_1)) : other.getter),
+setter(other.defaults ? Setter(std::bind(&field<Type>::default_setter, this, std::placeholders::_1, std::placeholders::_2)) : other.setter),
+defaults(other.defaults)
 { }
 
 template<>
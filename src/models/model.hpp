@@ -32,6 +32,7 @@ namespace models {
 		bool exists(const PrimaryKey&);
 		bool read(const PrimaryKey&);
 		bool write(const PrimaryKey&);
+		const std::string& get_filename();
 
 	protected:
 		typedef field<PrimaryKey> primary_key;
@@ -45,6 +46,8 @@ namespace models {
 		model(const std::string&, const std::string&);
 
 		void parse();
+		std::map<PrimaryKey, json::Value*> load(json::Document&);
+		void replace(json::Document&, std::map<PrimaryKey, json::Value*>&);
 		virtual primary_key& get_primary_key() = 0;
 		virtual void operator<<(json::Value&) = 0;
 		virtual void operator>>(json::Value&) = 0;
@@ -96,6 +99,43 @@ void model<PrimaryKey>::parse() {
 	document.ParseStream(reader);
 }
 
+/**
+ *  Parses the file again into the given document without touching the dataset, so the caller can
+ *  compare both. Records are indexed by their key, read through a copy of the primary key field so
+ *  the current record is left as it was if the new file is rejected.
+ */
+template<typename PrimaryKey>
+std::map<PrimaryKey, json::Value*> model<PrimaryKey>::load(json::Document& incoming) {
+	std::ifstream input(filename);
+	json::IStreamWrapper reader(input);
+	incoming.ParseStream(reader);
+	if (incoming.HasParseError() || !incoming.HasMember(entry.c_str()) || !incoming[entry.c_str()].IsArray()) {
+		throw std::invalid_argument("Unable to parse '" + filename + "'.");
+	}
+
+	std::map<PrimaryKey, json::Value*> records;
+	primary_key key = get_primary_key();
+	for (auto& node: incoming[entry.c_str()].GetArray()) {
+		read(node, key);
+		records[key] = &node;
+	}
+	return records;
+}
+
+/**
+ *  Replaces the whole dataset by the records of a loaded document and keeps that document, so the
+ *  memory of the previous one is released with it instead of piling up on a single allocator.
+ */
+template<typename PrimaryKey>
+void model<PrimaryKey>::replace(json::Document& incoming, std::map<PrimaryKey, json::Value*>& records) {
+	std::map<PrimaryKey, json::Value> replacement;
+	for (auto& [key, node]: records) {
+		replacement[key] = *node;
+	}
+	dataset.swap(replacement);
+	document.Swap(incoming);
+}
+
 template<typename PrimaryKey>
 void model<PrimaryKey>::fetch() {
 	json::Value recordset;
@@ -201,4 +241,7 @@ bool model<PrimaryKey>::write(const PrimaryKey& key) {
 	return true;
 }
 
+template<typename PrimaryKey>
+inline const std::string& model<PrimaryKey>::get_filename() { return filename; }
+
 #endif // MODEL_HEADER
@@ -6,6 +6,8 @@
 #include <map>
 #include <limits>
 #include <functional>
+#include <set>
+#include <vector>
 
 #include "field.hpp"
 #include "model.hpp"
@@ -13,32 +15,59 @@
 
 namespace models {
 	using list_of_articles = std::map<int, int>;
+	using list_of_products = std::map<std::string, int>;
 
 	class product: public model<std::string> {
 	public:
-		product(article*);
+		struct changes {
+			std::set<std::string> added;
+			std::set<std::string> removed;
+			std::set<std::string> changed;
+		};
+
+		product(article*, const std::string& = "products");
 		inline primary_key& get_primary_key() override { return name; }
 		std::string get_name();
 		list_of_articles get_requirements();
+		list_of_products get_components();
+		list_of_articles get_bill();
+		hashset<std::string> get_dependants();
 		int get_availability();
+		const std::map<std::string, int>& get_availabilities();
 		void list();
 		bool is_available();
 		void update_availability(int);
+		void refresh_availability();
+		changes reload();
 
 	protected:
 		void operator<<(json::Value&) override;
 		void operator>>(json::Value&) override;
 
 	private:
+		static const std::string requirements_key;
 		static const std::string article_id_key;
 		static const std::string amount_key;
+		static const std::string components_key;
+		static const std::string component_name_key;
 		models::article* inventory;
 		std::map<std::string, int> availability;
+		std::map<std::string, list_of_articles> bills;
+		hashmap<std::string, hashset<std::string>> dependants;
 		field<std::string> name;
 		field<list_of_articles> requirements;
+		field<list_of_products> components;
 
 		list_of_articles get_requirements_from(json::Value&);
 		void set_requirements_to(json::Value&, const list_of_articles&);
+		list_of_products get_components_from(json::Value&);
+		void set_components_to(json::Value&, const list_of_products&);
+		list_of_products peek_components(json::Value&);
+		void check_requirements(const std::string&, json::Value&);
+		int check_integer(const std::string&, json::Value&, const std::string&);
+		void unlink(const std::string&);
+		std::vector<std::string> sort_topologically(const std::map<std::string, list_of_products>&);
+		void compute_bill(const std::string&);
 		void compute_initial_availabilities();
 		void update_availability(const std::string&);
 	};
@@ -47,15 +76,23 @@ namespace models {
 using models::model;
 using models::product;
 using models::list_of_articles;
+using models::list_of_products;
 
+const std::string product::requirements_key("contain_articles");
 const std::string product::article_id_key("art_id");
 const std::string product::amount_key("amount_of");
+const std::string product::components_key("contain_products");
+const std::string product::component_name_key("name");
 
-product::product(article* inventory):
-	model("products"), inventory(inventory), name("name"),
-	requirements("contain_articles",
+product::product(article* inventory, const std::string& source):
+	model(source, "products"), inventory(inventory), name("name"),
+	requirements(requirements_key,
 		std::bind(&product::get_requirements_from, this, std::placeholders::_1),
 		std::bind(&product::set_requirements_to, this, std::placeholders::_1, std::placeholders::_2)
+	),
+	components(components_key,
+		std::bind(&product::get_components_from, this, std::placeholders::_1),
+		std::bind(&product::set_components_to, this, std::placeholders::_1, std::placeholders::_2)
 	) {
 
 	if (inventory == NULL) {
@@ -66,14 +103,35 @@ product::product(article* inventory):
 	compute_initial_availabilities();
 }
 
-inline void product::operator<<(json::Value& node) { read(node, name, requirements); }
+// Components are optional, most of the products are made only from articles.
+void product::operator<<(json::Value& node) {
+	read(node, name, requirements);
+	if (node.HasMember(components_key.c_str())) {
+		read(node, components);
+	} else {
+		components = list_of_products();
+	}
+}
 
-inline void product::operator>>(json::Value& node) { write(node, name, requirements); }
+void product::operator>>(json::Value& node) {
+	write(node, name, requirements);
+	if (node.HasMember(components_key.c_str())) {
+		write(node, components);
+	}
+}
 
 inline std::string product::get_name() { return name; }
 
 inline list_of_articles product::get_requirements() { return requirements; };
 
+inline list_of_products product::get_components() { return components; };
+
+inline list_of_articles product::get_bill() { return bills[name]; }
+
+hashset<std::string> product::get_dependants() {
+	return dependants[name];
+}
+
 int product::get_availability() {
 	if (!exists(name)) {
 		throw invalid_key(name);
@@ -82,6 +140,8 @@ int product::get_availability() {
 	return availability[name];
 }
 
+inline const std::map<std::string, int>& product::get_availabilities() { return availability; }
+
 inline bool product::is_available() { return get_availability() > 0; }
 
 list_of_articles product::get_requirements_from(json::Value& node) {
@@ -110,9 +170,220 @@ void product::set_requirements_to(json::Value& node, const list_of_articles& req
 	node = list;
 };
 
+list_of_products product::get_components_from(json::Value& node) {
+	list_of_products components;
+	for (auto& component: node.GetArray()) {
+		std::string component_name = component[component_name_key.c_str()].GetString();
+		int amount = std::stoi(component[amount_key.c_str()].GetString());
+		if (amount <= 0) continue;
+		components[component_name] = amount;
+		dependants[component_name].insert(name);
+	}
+	return components;
+};
+
+void product::set_components_to(json::Value& node, const list_of_products& components) {
+	json::Document::AllocatorType& allocator = document.GetAllocator();
+	json::Value list(json::kArrayType);
+	for (auto& component: components) {
+		std::string* amount = new std::string(std::to_string(component.second));
+		json::Value entry(json::kObjectType);
+		entry.AddMember(json::StringRef(component_name_key.c_str()), json::StringRef(component.first.c_str()), allocator);
+		entry.AddMember(json::StringRef(amount_key.c_str()), json::StringRef(amount->c_str()), allocator);
+		list.PushBack(entry, allocator);
+	}
+	node = list;
+};
+
+/**
+ *  Reads the components of a product node without linking them to the product, so a new catalog
+ *  can be checked before it replaces the current one.
+ */
+list_of_products product::peek_components(json::Value& node) {
+	list_of_products components;
+	if (!node.HasMember(components_key.c_str())) return components;
+	for (auto& component: node[components_key.c_str()].GetArray()) {
+		int amount = std::stoi(component[amount_key.c_str()].GetString());
+		if (amount <= 0) continue;
+		components[component[component_name_key.c_str()].GetString()] = amount;
+	}
+	return components;
+}
+
+/**
+ *  Checks everything a product node needs to be read: its articles exist, and the amounts of its
+ *  articles and components are numbers. So reading it can't fail once the catalog is replaced.
+ */
+void product::check_requirements(const std::string& name, json::Value& node) {
+	if (!node.HasMember(requirements_key.c_str()) || !node[requirements_key.c_str()].IsArray()) {
+		throw std::invalid_argument("Product '" + name + "' has no list of articles.");
+	}
+	for (auto& material: node[requirements_key.c_str()].GetArray()) {
+		int article_id = check_integer(name, material, article_id_key);
+		check_integer(name, material, amount_key);
+		if (!inventory->exists(article_id)) {
+			throw std::invalid_argument("Product '" + name + "' is made from unknown article '" + std::to_string(article_id) + "'.");
+		}
+	}
+
+	if (!node.HasMember(components_key.c_str())) return;
+	if (!node[components_key.c_str()].IsArray()) {
+		throw std::invalid_argument("Product '" + name + "' has an invalid list of products.");
+	}
+	for (auto& component: node[components_key.c_str()].GetArray()) {
+		check_integer(name, component, amount_key);
+		if (!component.HasMember(component_name_key.c_str()) || !component[component_name_key.c_str()].IsString()) {
+			throw std::invalid_argument("Product '" + name + "' is made from a product without name.");
+		}
+	}
+}
+
+// All the integers on the file are actually strings.
+int product::check_integer(const std::string& name, json::Value& entry, const std::string& key) {
+	if (entry.IsObject() && entry.HasMember(key.c_str()) && entry[key.c_str()].IsString()) {
+		try {
+			return std::stoi(entry[key.c_str()].GetString());
+		} catch(const std::logic_error&) { }
+	}
+	throw std::invalid_argument("Product '" + name + "' has an invalid '" + key + "'.");
+}
+
+void product::unlink(const std::string& name) {
+	read(name);
+	for (auto& [article_id, amount]: get_requirements()) {
+		inventory->unsubscribe(article_id, name);
+	}
+	for (auto& [component, amount]: get_components()) {
+		dependants[component].erase(name);
+	}
+}
+
+/**
+ *  Applies only the differences between the file and the loaded catalog. The new catalog is checked
+ *  as a whole first, so nothing changes if it's invalid. Then the replaced and removed products are
+ *  unlinked from their articles and components, the new definitions are linked, and bills and
+ *  availabilities are computed again just for the products changed and the ones made from them.
+ */
+product::changes product::reload() {
+	json::Document parsed;
+	std::map<std::string, json::Value*> incoming = load(parsed);
+	std::map<std::string, list_of_products> graph;
+	changes result;
+	for (auto& [key, node]: incoming) {
+		if (!dataset.count(key)) {
+			result.added.insert(key);
+			check_requirements(key, *node);
+		} else if (dataset[key] != *node) {
+			result.changed.insert(key);
+			check_requirements(key, *node);
+		}
+		graph[key] = peek_components(*node);
+	}
+	for (auto& record: dataset) {
+		if (!incoming.count(record.first)) result.removed.insert(record.first);
+	}
+	std::vector<std::string> order = sort_topologically(graph);
+
+	for (auto& key: result.removed) {
+		unlink(key);
+		availability.erase(key);
+		bills.erase(key);
+		dependants.erase(key);
+	}
+
+	std::set<std::string> affected;
+	for (auto& key: result.changed) {
+		unlink(key);
+		affected.insert(key);
+	}
+	for (auto& key: result.added) {
+		affected.insert(key);
+	}
+	replace(parsed, incoming);
+	for (auto& key: affected) {
+		read(key);
+	}
+
+	std::vector<std::string> pending(affected.begin(), affected.end());
+	while (!pending.empty()) {
+		std::string current = pending.back();
+		pending.pop_back();
+		for (auto& dependant: dependants[current]) {
+			if (affected.insert(dependant).second) pending.push_back(dependant);
+		}
+	}
+	for (auto& key: order) {
+		if (!affected.count(key)) continue;
+		compute_bill(key);
+		update_availability(key);
+	}
+	return result;
+}
+
+/**
+ *  Orders the products so every product comes after the ones it's made from, checking on the way
+ *  that all the components exist and that no product is (indirectly) made from itself.
+ */
+std::vector<std::string> product::sort_topologically(const std::map<std::string, list_of_products>& graph) {
+	enum { VISITING = 1, VISITED = 2 };
+	std::map<std::string, int> state;
+	std::vector<std::string> order;
+	std::vector<std::pair<std::string, list_of_products::const_iterator>> path;
+	for (auto& [root, ignored]: graph) {
+		if (state[root]) continue;
+		state[root] = VISITING;
+		path.emplace_back(root, graph.at(root).begin());
+		while (!path.empty()) {
+			auto& [current, next] = path.back();
+			if (next == graph.at(current).end()) {
+				state[current] = VISITED;
+				order.push_back(current);
+				path.pop_back();
+				continue;
+			}
+			const std::string& component = (next++)->first;
+			if (!graph.count(component)) {
+				throw std::invalid_argument("Product '" + current + "' is made from unknown product '" + component + "'.");
+			}
+			if (state[component] == VISITING) {
+				throw std::invalid_argument("Product '" + component + "' is made from itself.");
+			}
+			if (!state[component]) {
+				state[component] = VISITING;
+				path.emplace_back(component, graph.at(component).begin());
+			}
+		}
+	}
+	return order;
+}
+
+/**
+ *  The bill of a product is the flat list of articles needed to make it, memoized per product so
+ *  it can be built from the bills of its components as long as they are computed first.
+ */
+void product::compute_bill(const std::string& name) {
+	if (!read(name) ) {
+		throw invalid_key(name);
+	}
+	list_of_articles bill = this->requirements;
+	list_of_products components = this->components;
+	for (auto& [component, amount]: components) {
+		for (auto& [article_id, required]: bills[component]) {
+			bill[article_id] += amount * required;
+		}
+	}
+	bills[name] = bill;
+}
+
 void product::compute_initial_availabilities() {
+	std::map<std::string, list_of_products> graph;
 	for (auto& record: dataset) {
-		update_availability(record.first);
+		read(record.first);
+		graph[record.first] = components;
+	}
+	for (auto& name: sort_topologically(graph)) {
+		compute_bill(name);
+		update_availability(name);
 	}
 }
 
@@ -121,14 +392,16 @@ void product::update_availability(const std::string& name) {
 		throw invalid_key(name);
 	}
 	availability[name] = std::numeric_limits<int>::max();
-	list_of_articles requirements = this->requirements;
-	for (auto& material: requirements) {
+	list_of_articles bill = bills[name];
+	for (auto& material: bill) {
 		update_availability(material.first);
 	}
 }
 
+inline void product::refresh_availability() { update_availability(get_name()); }
+
 void product::update_availability(int article_id) {
-	const list_of_articles& requirements = get_requirements();
+	const list_of_articles& requirements = bills[name];
 	list_of_articles::const_iterator result = requirements.find(article_id);
 	if (result != requirements.end()) {
 		inventory->read(article_id);
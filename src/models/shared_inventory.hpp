@@ -0,0 +1,517 @@
+#ifndef SHARED_INVENTORY_HEADER
+#define SHARED_INVENTORY_HEADER
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "article.hpp"
+#include "product.hpp"
+
+namespace models {
+	/**
+	 *  Stock, bills and availabilities kept in a POSIX shared-memory segment, so several processes
+	 *  on the same host can serve sales from one state. The first process creates the segment from
+	 *  its models, the next ones attach to it as long as they loaded the same catalog.
+	 *
+	 *  Updates are serialised by a process-shared robust mutex and logged on an undo journal before
+	 *  touching the stock, so if a process dies half way the next one to take the lock rolls the
+	 *  update back. Stock and availabilities are atomics, so they can be read without the lock.
+	 *
+	 *  Holds are recorded in the segment with the process which placed them, so the articles held by
+	 *  a process which is gone are put back in the stock when another one attaches or recovers. The
+	 *  table of holds is sized by the process creating the segment, and its free slots are chained.
+	 */
+	class shared_inventory {
+	public:
+		shared_inventory(const std::string&, article*, product*, std::uint32_t);
+		~shared_inventory();
+		bool adjust(const list_of_articles&, int);
+		int hold(const std::string&);
+		void confirm(int);
+		void release(int);
+		int get_stock(int);
+		const std::map<std::string, int>& get_availabilities();
+
+	protected:
+		static_assert(std::atomic<int>::is_always_lock_free, "Shared stock requires lock-free integers.");
+		static constexpr std::uint32_t magic = 0x57485348;
+		static constexpr std::uint32_t ready = 1;
+		static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+		static const std::chrono::seconds patience;
+
+		struct hold_entry {
+			pid_t owner;
+			std::uint32_t product;
+			std::uint32_t next;
+		};
+		struct header {
+			std::uint32_t magic;
+			std::atomic<std::uint32_t> state;
+			std::uint64_t fingerprint;
+			std::uint32_t articles;
+			std::uint32_t products;
+			std::uint32_t requirements;
+			std::uint32_t subscriptions;
+			std::uint32_t hold_capacity;
+			std::uint32_t free_hold;
+			std::uint32_t journal_capacity;
+			std::uint32_t journal_size;
+			std::uint32_t journal_slot;
+			hold_entry journal_hold;
+			std::uint32_t journal_free;
+			std::atomic<std::uint32_t> journal_pending;
+			pthread_mutex_t lock;
+		};
+		struct stock_entry {
+			int id;
+			std::atomic<int> stock;
+			std::uint32_t first_subscriber;
+			std::uint32_t subscribers;
+		};
+		struct product_entry {
+			std::atomic<int> availability;
+			std::uint32_t first_requirement;
+			std::uint32_t requirements;
+		};
+		struct requirement_entry {
+			std::uint32_t article;
+			int amount;
+		};
+		struct journal_entry {
+			std::uint32_t article;
+			int stock;
+		};
+
+		class guard {
+		public:
+			guard(shared_inventory&);
+			~guard();
+		private:
+			shared_inventory& inventory;
+		};
+
+		std::string name;
+		std::size_t size;
+		void* segment;
+		header* info;
+		stock_entry* stocks;
+		product_entry* products;
+		requirement_entry* requirements;
+		std::uint32_t* subscriptions;
+		journal_entry* journal;
+		hold_entry* holds;
+		hashmap<int, std::uint32_t> article_index;
+		hashmap<std::string, std::uint32_t> product_index;
+		std::map<std::string, int> availabilities;
+
+		static std::size_t get_size(const header&);
+		void map(int, std::size_t);
+		void locate();
+		void create(int, const header&, article*, product*, const std::vector<list_of_articles>&);
+		void attach(int, const header&);
+		void recover();
+		void release_orphans();
+		void open_journal(std::uint32_t, std::uint32_t);
+		void close_journal();
+		void move(std::uint32_t, int, std::uint32_t, pid_t);
+		void update_availability(std::uint32_t);
+	};
+}
+
+using models::shared_inventory;
+
+const std::chrono::seconds shared_inventory::patience(5);
+
+shared_inventory::shared_inventory(const std::string& name, article* inventory, product* catalog, std::uint32_t capacity):
+	name(name[0] == '/' ? name : "/" + name), size(0), segment(MAP_FAILED) {
+
+	if (inventory == NULL || catalog == NULL) {
+		throw std::invalid_argument("Invalid inventory.");
+	}
+	if (this->name.size() < 2) {
+		throw std::invalid_argument("A name is required for the shared inventory!");
+	}
+
+	// The layout and the fingerprint only depend on the catalog, so every process computes the same.
+	header layout = {};
+	layout.magic = magic;
+	layout.hold_capacity = capacity;
+	layout.fingerprint = 14695981039346656037ull;
+	auto mix = [&layout](std::uint64_t value) {
+		layout.fingerprint = (layout.fingerprint ^ value) * 1099511628211ull;
+	};
+	std::vector<list_of_articles> bills;
+	for (auto& id: inventory->get_all_keys()) {
+		article_index[id] = layout.articles++;
+		mix(id);
+	}
+	for (auto& [product_name, availability]: catalog->get_availabilities()) {
+		availabilities[product_name] = availability;
+		product_index[product_name] = layout.products;
+		catalog->read(product_name);
+		bills.push_back(catalog->get_bill());
+		for (char letter: product_name) mix(letter);
+		for (auto& [article_id, amount]: bills.back()) {
+			mix(article_id);
+			mix(amount);
+			layout.subscriptions++;
+		}
+		layout.requirements += bills.back().size();
+		layout.journal_capacity = std::max<std::uint32_t>(layout.journal_capacity, bills.back().size());
+		layout.products++;
+	}
+
+	int descriptor = shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (descriptor >= 0) {
+		try {
+			create(descriptor, layout, inventory, catalog, bills);
+		} catch(const std::exception&) {
+			shm_unlink(this->name.c_str());
+			throw;
+		}
+	} else if (errno == EEXIST && (descriptor = shm_open(this->name.c_str(), O_RDWR, 0600)) >= 0) {
+		attach(descriptor, layout);
+	} else {
+		throw std::runtime_error("Unable to open shared inventory '" + this->name + "': " + std::strerror(errno));
+	}
+}
+
+shared_inventory::~shared_inventory() {
+	if (segment != MAP_FAILED) munmap(segment, size);
+}
+
+std::size_t shared_inventory::get_size(const header& layout) {
+	return sizeof(header)
+		+ layout.articles * sizeof(stock_entry)
+		+ layout.products * sizeof(product_entry)
+		+ layout.requirements * sizeof(requirement_entry)
+		+ layout.journal_capacity * sizeof(journal_entry)
+		+ layout.hold_capacity * sizeof(hold_entry)
+		+ layout.subscriptions * sizeof(std::uint32_t);
+}
+
+void shared_inventory::map(int descriptor, std::size_t size) {
+	// The mapping outlives the descriptor.
+	segment = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (segment == MAP_FAILED) {
+		throw std::runtime_error("Unable to map shared inventory '" + name + "': " + std::strerror(errno));
+	}
+	this->size = size;
+	info = static_cast<header*>(segment);
+}
+
+void shared_inventory::locate() {
+	// Entries are laid out from the widest alignment to the narrowest one.
+	stocks = reinterpret_cast<stock_entry*>(info + 1);
+	products = reinterpret_cast<product_entry*>(stocks + info->articles);
+	requirements = reinterpret_cast<requirement_entry*>(products + info->products);
+	journal = reinterpret_cast<journal_entry*>(requirements + info->requirements);
+	holds = reinterpret_cast<hold_entry*>(journal + info->journal_capacity);
+	subscriptions = reinterpret_cast<std::uint32_t*>(holds + info->hold_capacity);
+}
+
+void shared_inventory::create(
+	int descriptor, const header& layout,
+	article* inventory, product* catalog, const std::vector<list_of_articles>& bills
+) {
+	std::size_t size = get_size(layout);
+	if (ftruncate(descriptor, size) < 0) {
+		close(descriptor);
+		throw std::runtime_error("Unable to size shared inventory '" + name + "': " + std::strerror(errno));
+	}
+	map(descriptor, size);
+
+	info = new(segment) header();
+	info->magic = layout.magic;
+	info->fingerprint = layout.fingerprint;
+	info->articles = layout.articles;
+	info->products = layout.products;
+	info->requirements = layout.requirements;
+	info->subscriptions = layout.subscriptions;
+	info->journal_capacity = layout.journal_capacity;
+	info->journal_pending = 0;
+	info->hold_capacity = layout.hold_capacity;
+	info->free_hold = layout.hold_capacity ? 0 : none;
+	locate();
+	for (std::uint32_t slot = 0; slot < info->hold_capacity; ++slot) {
+		holds[slot] = {0, 0, slot + 1 < info->hold_capacity ? slot + 1 : none};
+	}
+
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+	pthread_mutex_init(&info->lock, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+
+	std::vector<std::vector<std::uint32_t>> subscribers(info->articles);
+	std::uint32_t requirement = 0;
+	for (std::uint32_t index = 0; index < info->products; ++index) {
+		product_entry* entry = new(&products[index]) product_entry();
+		entry->first_requirement = requirement;
+		entry->requirements = bills[index].size();
+		for (auto& [article_id, amount]: bills[index]) {
+			requirements[requirement++] = {article_index.at(article_id), amount};
+			subscribers[article_index.at(article_id)].push_back(index);
+		}
+	}
+
+	std::uint32_t subscription = 0;
+	for (auto& [id, index]: article_index) {
+		stock_entry* entry = new(&stocks[index]) stock_entry();
+		inventory->read(id);
+		entry->id = id;
+		entry->stock = inventory->get_stock();
+		entry->first_subscriber = subscription;
+		entry->subscribers = subscribers[index].size();
+		for (auto& product: subscribers[index]) {
+			subscriptions[subscription++] = product;
+		}
+	}
+
+	for (std::uint32_t index = 0; index < info->products; ++index) {
+		update_availability(index);
+	}
+	info->state = ready;
+}
+
+// The size of the table of holds is taken from the segment, it's up to the process which created it.
+void shared_inventory::attach(int descriptor, const header& layout) {
+	// The creator may still be sizing or filling the segment.
+	auto deadline = std::chrono::steady_clock::now() + patience;
+	struct stat status;
+	while (fstat(descriptor, &status) == 0 && !status.st_size) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			close(descriptor);
+			throw std::runtime_error("Shared inventory '" + name + "' was never initialised, please remove it.");
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	if (static_cast<std::size_t>(status.st_size) < sizeof(header)) {
+		close(descriptor);
+		throw std::runtime_error("Shared inventory '" + name + "' was created from a different catalog.");
+	}
+
+	map(descriptor, status.st_size);
+	while (info->state != ready) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			throw std::runtime_error("Shared inventory '" + name + "' was never initialised, please remove it.");
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	if (info->magic != magic || info->fingerprint != layout.fingerprint || size != get_size(*info)) {
+		throw std::runtime_error("Shared inventory '" + name + "' was created from a different catalog.");
+	}
+	locate();
+
+	guard lock(*this);
+	release_orphans();
+}
+
+shared_inventory::guard::guard(shared_inventory& inventory): inventory(inventory) {
+	int result = pthread_mutex_lock(&inventory.info->lock);
+	if (result == EOWNERDEAD) {
+		inventory.recover();
+		pthread_mutex_consistent(&inventory.info->lock);
+	} else if (result) {
+		throw std::runtime_error("Shared inventory is not recoverable: " + std::string(std::strerror(result)));
+	}
+}
+
+shared_inventory::guard::~guard() { pthread_mutex_unlock(&inventory.info->lock); }
+
+// The previous owner died holding the lock, so whatever it was updating is rolled back.
+void shared_inventory::recover() {
+	if (info->journal_pending) {
+		std::clog << "Rolling back an interrupted update on shared inventory '" << name << "'..." << std::endl;
+		for (std::uint32_t index = 0; index < info->journal_size; ++index) {
+			stocks[journal[index].article].stock = journal[index].stock;
+		}
+		if (info->journal_slot != none) {
+			holds[info->journal_slot] = info->journal_hold;
+		}
+		info->free_hold = info->journal_free;
+		for (std::uint32_t index = 0; index < info->products; ++index) {
+			update_availability(index);
+		}
+		info->journal_pending = 0;
+	}
+	release_orphans();
+}
+
+// Holds of a process which is gone can't be confirmed nor expire, so their articles go back now.
+void shared_inventory::release_orphans() {
+	std::uint32_t released = 0;
+	std::map<pid_t, bool> gone;
+	for (std::uint32_t slot = 0; slot < info->hold_capacity; ++slot) {
+		pid_t owner = holds[slot].owner;
+		if (!owner) continue;
+		auto known = gone.find(owner);
+		if (known == gone.end()) {
+			known = gone.emplace(owner, kill(owner, 0) < 0 && errno == ESRCH).first;
+		}
+		if (!known->second) continue;
+		move(holds[slot].product, +1, slot, 0);
+		released++;
+	}
+	if (released) {
+		std::clog << "Released " << released << " holds left by finished processes on shared inventory '" << name << "'." << std::endl;
+	}
+}
+
+bool shared_inventory::adjust(const list_of_articles& bill, int direction) {
+	if (bill.size() > info->journal_capacity) {
+		throw std::invalid_argument("Bill of articles doesn't belong to the shared catalog.");
+	}
+	guard lock(*this);
+	if (direction < 0) {
+		for (auto& [article_id, amount]: bill) {
+			if (stocks[article_index.at(article_id)].stock < amount) return false;
+		}
+	}
+
+	std::uint32_t pending = 0;
+	for (auto& [article_id, amount]: bill) {
+		std::uint32_t index = article_index.at(article_id);
+		journal[pending++] = {index, stocks[index].stock};
+	}
+	open_journal(pending, none);
+
+	for (auto& [article_id, amount]: bill) {
+		stocks[article_index.at(article_id)].stock += direction * amount;
+	}
+	for (auto& [article_id, amount]: bill) {
+		stock_entry& entry = stocks[article_index.at(article_id)];
+		for (std::uint32_t index = 0; index < entry.subscribers; ++index) {
+			update_availability(subscriptions[entry.first_subscriber + index]);
+		}
+	}
+	close_journal();
+	return true;
+}
+
+/**
+ *  Holds a product for this process, taking its bill of articles out of the stock and a slot out of
+ *  the free ones in the same journaled update. Gives back the slot, or -1 if it's not available.
+ */
+int shared_inventory::hold(const std::string& product_name) {
+	if (!product_index.count(product_name)) {
+		throw std::invalid_argument("Product doesn't exists!");
+	}
+	std::uint32_t index = product_index[product_name];
+	guard lock(*this);
+	if (products[index].availability <= 0) return -1;
+	if (info->free_hold == none) {
+		throw std::runtime_error("Too many holds on shared inventory '" + name + "'.");
+	}
+	std::uint32_t slot = info->free_hold;
+	move(index, -1, slot, getpid());
+	return slot;
+}
+
+void shared_inventory::confirm(int slot) {
+	guard lock(*this);
+	move(holds[slot].product, 0, slot, 0);
+}
+
+void shared_inventory::release(int slot) {
+	guard lock(*this);
+	move(holds[slot].product, +1, slot, 0);
+}
+
+/**
+ *  Logs the state of the hold slot and of the free ones next to the stock already logged, so the
+ *  update is rolled back as a whole. The journal is pending from here until it's closed.
+ */
+void shared_inventory::open_journal(std::uint32_t entries, std::uint32_t slot) {
+	info->journal_size = entries;
+	info->journal_slot = slot;
+	if (slot != none) {
+		info->journal_hold = holds[slot];
+	}
+	info->journal_free = info->free_hold;
+	info->journal_pending = 1;
+}
+
+inline void shared_inventory::close_journal() { info->journal_pending = 0; }
+
+/**
+ *  Moves the bill of a product in or out of the stock (or neither, without direction), and takes a
+ *  hold slot out of the free ones for an owner, or puts it back without owner.
+ */
+void shared_inventory::move(std::uint32_t index, int direction, std::uint32_t slot, pid_t owner) {
+	product_entry& entry = products[index];
+	std::uint32_t changes = direction ? entry.requirements : 0;
+	for (std::uint32_t offset = 0; offset < changes; ++offset) {
+		requirement_entry& requirement = requirements[entry.first_requirement + offset];
+		journal[offset] = {requirement.article, stocks[requirement.article].stock};
+	}
+	open_journal(changes, slot);
+
+	for (std::uint32_t offset = 0; offset < changes; ++offset) {
+		requirement_entry& requirement = requirements[entry.first_requirement + offset];
+		stocks[requirement.article].stock += direction * requirement.amount;
+	}
+	if (owner) {
+		info->free_hold = holds[slot].next;
+		holds[slot] = {owner, index, none};
+	} else {
+		holds[slot] = {0, 0, info->free_hold};
+		info->free_hold = slot;
+	}
+	for (std::uint32_t offset = 0; offset < changes; ++offset) {
+		stock_entry& article = stocks[requirements[entry.first_requirement + offset].article];
+		for (std::uint32_t subscriber = 0; subscriber < article.subscribers; ++subscriber) {
+			update_availability(subscriptions[article.first_subscriber + subscriber]);
+		}
+	}
+	close_journal();
+}
+
+void shared_inventory::update_availability(std::uint32_t index) {
+	product_entry& entry = products[index];
+	int availability = std::numeric_limits<int>::max();
+	for (std::uint32_t offset = 0; offset < entry.requirements; ++offset) {
+		requirement_entry& requirement = requirements[entry.first_requirement + offset];
+		availability = std::min(availability, stocks[requirement.article].stock / requirement.amount);
+	}
+	entry.availability = availability;
+}
+
+int shared_inventory::get_stock(int article_id) {
+	if (!article_index.count(article_id)) {
+		throw std::invalid_argument("Record with key = '" + std::to_string(article_id) + "' not found!");
+	}
+	return stocks[article_index[article_id]].stock;
+}
+
+// Both the products in the segment and the map are sorted by name, so they are walked together.
+const std::map<std::string, int>& shared_inventory::get_availabilities() {
+	std::uint32_t index = 0;
+	for (auto& [product_name, availability]: availabilities) {
+		availability = products[index++].availability;
+	}
+	return availabilities;
+}
+
+#endif // SHARED_INVENTORY_HEADER
@@ -0,0 +1,199 @@
+#ifndef SIMULATION_SIMULATOR_HEADER
+#define SIMULATION_SIMULATOR_HEADER
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "simulation/snapshot.hpp"
+
+namespace simulation {
+	/**
+	 *  Runs random streams of sell orders against snapshots of the stock and availabilities, across
+	 *  a pool of threads, without touching the live models. Orders follow the same rules as selling:
+	 *  a product is sold only while available, its bill of articles is taken out of the stock and
+	 *  the availability of the products subscribed to those articles goes down accordingly.
+	 *
+	 *  Subscribers are taken from the flattened bills, so products made from components are reached
+	 *  directly rather than through their dependants as in warehouse::propagate. Both must give the
+	 *  same availabilities, and utz/simulation/simulator.tpp checks it against warehouse::sell.
+	 */
+	class simulator {
+	public:
+		struct settings {
+			std::size_t scenarios = 1000;
+			std::size_t orders = 100;
+			unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+			std::uint64_t seed = std::random_device()();
+			std::map<std::string, double> mix;
+		};
+
+		simulator(
+			const std::vector<std::string>&,
+			const std::vector<std::map<int, int>>&,
+			const std::map<int, int>&,
+			const std::vector<int>&
+		);
+		void run(const settings&);
+		void report(std::ostream&);
+
+	private:
+		struct statistics {
+			std::size_t demanded = 0;
+			std::size_t fulfilled = 0;
+			std::size_t stockouts = 0;
+			std::size_t stockout_orders = 0;
+		};
+		typedef std::vector<std::pair<std::size_t, int>> requirements;
+
+		std::vector<std::string> names;
+		std::vector<requirements> bills;
+		std::vector<requirements> subscribers;
+		simulation::snapshot<int> stocks;
+		simulation::snapshot<int> availabilities;
+		std::vector<statistics> results;
+		std::size_t scenarios;
+
+		void simulate(std::size_t, const settings&, const std::vector<double>&, std::vector<statistics>&);
+	};
+}
+
+using simulation::simulator;
+
+simulator::simulator(
+	const std::vector<std::string>& names,
+	const std::vector<std::map<int, int>>& bills,
+	const std::map<int, int>& stocks,
+	const std::vector<int>& availabilities
+):
+	names(names), bills(names.size()), subscribers(stocks.size()),
+	stocks([&stocks]() {
+		std::vector<int> values;
+		for (auto& [id, stock]: stocks) values.push_back(stock);
+		return values;
+	}()),
+	availabilities(availabilities), scenarios(0) {
+
+	// Articles are indexed in the order of their IDs, and subscribers carry the amount they require.
+	std::map<int, std::size_t> index;
+	for (auto& [id, stock]: stocks) {
+		index.emplace(id, index.size());
+	}
+	for (std::size_t product = 0; product < names.size(); ++product) {
+		for (auto& [id, amount]: bills[product]) {
+			if (!index.count(id)) {
+				throw std::invalid_argument("Record with key = '" + std::to_string(id) + "' not found!");
+			}
+			this->bills[product].emplace_back(index[id], amount);
+			subscribers[index[id]].emplace_back(product, amount);
+		}
+	}
+}
+
+// Product names come sorted, so the ones in the mix are found by binary search.
+void simulator::run(const settings& configuration) {
+	if (names.empty()) {
+		throw std::invalid_argument("There are no products to simulate!");
+	}
+	std::vector<double> weights(names.size(), configuration.mix.empty() ? 1 : 0);
+	for (auto& [name, weight]: configuration.mix) {
+		auto position = std::lower_bound(names.begin(), names.end(), name);
+		if (position == names.end() || *position != name) {
+			throw std::invalid_argument("Product '" + name + "' doesn't exists!");
+		}
+		weights[position - names.begin()] = weight;
+	}
+
+	scenarios = configuration.scenarios;
+	results.assign(names.size(), statistics());
+	std::atomic<std::size_t> next(0);
+	std::mutex merge;
+	std::vector<std::thread> pool;
+	for (unsigned worker = 0; worker < std::max(configuration.threads, 1u); ++worker) {
+		pool.emplace_back([&]() {
+			std::vector<statistics> partial(names.size());
+			for (std::size_t scenario = next++; scenario < scenarios; scenario = next++) {
+				simulate(scenario, configuration, weights, partial);
+			}
+			std::lock_guard<std::mutex> lock(merge);
+			for (std::size_t product = 0; product < names.size(); ++product) {
+				results[product].demanded += partial[product].demanded;
+				results[product].fulfilled += partial[product].fulfilled;
+				results[product].stockouts += partial[product].stockouts;
+				results[product].stockout_orders += partial[product].stockout_orders;
+			}
+		});
+	}
+	for (auto& thread: pool) {
+		thread.join();
+	}
+}
+
+void simulator::simulate(
+	std::size_t scenario, const settings& configuration,
+	const std::vector<double>& weights, std::vector<statistics>& partial
+) {
+	simulation::snapshot<int> stock(stocks);
+	simulation::snapshot<int> availability(availabilities);
+	std::mt19937_64 generator(configuration.seed + scenario);
+	std::discrete_distribution<std::size_t> demand(weights.begin(), weights.end());
+	std::vector<bool> out_of_stock(names.size());
+
+	auto run_out = [&](std::size_t product, std::size_t order) {
+		if (out_of_stock[product]) return;
+		out_of_stock[product] = true;
+		partial[product].stockouts++;
+		partial[product].stockout_orders += order;
+	};
+	for (std::size_t product = 0; product < names.size(); ++product) {
+		if (availability.get(product) <= 0) run_out(product, 0);
+	}
+
+	for (std::size_t order = 1; order <= configuration.orders; ++order) {
+		std::size_t product = demand(generator);
+		partial[product].demanded++;
+		if (availability.get(product) <= 0) continue;
+		partial[product].fulfilled++;
+		for (auto& [article, amount]: bills[product]) {
+			int left = stock.get(article) - amount;
+			stock.set(article, left);
+			for (auto& [subscriber, required]: subscribers[article]) {
+				int can_afford = left / required;
+				if (can_afford < availability.get(subscriber)) {
+					availability.set(subscriber, can_afford);
+				}
+				if (can_afford <= 0) run_out(subscriber, order);
+			}
+		}
+	}
+}
+
+void simulator::report(std::ostream& output) {
+	output << std::fixed << std::setprecision(2);
+	for (std::size_t product = 0; product < names.size(); ++product) {
+		const statistics& result = results[product];
+		if (!result.demanded && !result.stockouts) continue;
+		output << names[product] << ": fill rate "
+			<< (result.demanded ? 100.0 * result.fulfilled / result.demanded : 100.0) << "%, ";
+		if (result.stockouts) {
+			output << "out of stock in " << 100.0 * result.stockouts / scenarios << "% of scenarios, "
+				<< "after " << static_cast<double>(result.stockout_orders) / result.stockouts << " orders on average";
+		} else {
+			output << "never out of stock";
+		}
+		output << '\n';
+	}
+	output.flush();
+}
+
+#endif // SIMULATION_SIMULATOR_HEADER
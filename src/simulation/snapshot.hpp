@@ -0,0 +1,61 @@
+#ifndef SIMULATION_SNAPSHOT_HEADER
+#define SIMULATION_SNAPSHOT_HEADER
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace simulation {
+	/**
+	 *  Copy-on-write array split in pages. Copying a snapshot only copies the page pointers, and a
+	 *  page is copied the first time it's written while shared with another snapshot, so each copy
+	 *  pays only for what it changes.
+	 *
+	 *  @type Type Data type of the values.
+	 *  @type PageSize Number of values per page.
+	 */
+	template<typename Type, std::size_t PageSize = 64>
+	class snapshot {
+	public:
+		snapshot(const std::vector<Type>&);
+		Type get(std::size_t) const;
+		void set(std::size_t, const Type&);
+		std::size_t size() const;
+
+	private:
+		typedef std::array<Type, PageSize> page;
+		std::vector<std::shared_ptr<page>> pages;
+		std::size_t length;
+	};
+}
+
+using simulation::snapshot;
+
+template<typename Type, std::size_t PageSize>
+snapshot<Type, PageSize>::snapshot(const std::vector<Type>& values): length(values.size()) {
+	for (std::size_t first = 0; first < length; first += PageSize) {
+		auto current = std::make_shared<page>();
+		std::copy(values.begin() + first, values.begin() + std::min(first + PageSize, length), current->begin());
+		pages.push_back(current);
+	}
+}
+
+template<typename Type, std::size_t PageSize>
+inline Type snapshot<Type, PageSize>::get(std::size_t index) const {
+	return (*pages[index / PageSize])[index % PageSize];
+}
+
+template<typename Type, std::size_t PageSize>
+void snapshot<Type, PageSize>::set(std::size_t index, const Type& value) {
+	std::shared_ptr<page>& current = pages[index / PageSize];
+	if (current.use_count() > 1) {
+		current = std::make_shared<page>(*current);
+	}
+	(*current)[index % PageSize] = value;
+}
+
+template<typename Type, std::size_t PageSize>
+inline std::size_t snapshot<Type, PageSize>::size() const { return length; }
+
+#endif // SIMULATION_SNAPSHOT_HEADER
@@ -0,0 +1,135 @@
+#ifndef TIMERS_WHEEL_HEADER
+#define TIMERS_WHEEL_HEADER
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace timers {
+	/**
+	 *  Hierarchical timer wheel: timers are kept in buckets by the tick they expire at, with
+	 *  coarser wheels for timers further in the future which are cascaded down to the finer ones
+	 *  as the time goes by. Scheduling and expiring a timer costs O(1) amortised no matter how many
+	 *  timers are outstanding, instead of scanning all of them on every tick.
+	 *
+	 *  @type Payload Data type of the value handed back when a timer expires.
+	 */
+	template<typename Payload>
+	class wheel {
+	public:
+		typedef std::function<void(const Payload&)> callback;
+
+		/**
+		 *  Constructor based on the first tick to be processed.
+		 *
+		 *  @param std::uint64_t Initial tick.
+		 */
+		wheel(std::uint64_t = 0);
+
+		/**
+		 *  Schedules a timer to expire at an absolute tick. Deadlines in the past expire on the
+		 *  next processed tick.
+		 *
+		 *  @param const Payload& Value to give back to the callback on expiry.
+		 *  @param std::uint64_t Tick when the timer expires.
+		 */
+		void schedule(const Payload&, std::uint64_t);
+
+		/**
+		 *  Processes every tick up to (and including) the given one, calling back for each timer
+		 *  expiring in between.
+		 *
+		 *  @param std::uint64_t Tick to advance to.
+		 *  @param const callback& Function to call with the payload of each expired timer.
+		 */
+		void advance(std::uint64_t, const callback&);
+
+		/**
+		 *  @returns std::size_t Number of timers still pending.
+		 */
+		std::size_t size();
+
+	private:
+		static constexpr unsigned bits = 6;
+		static constexpr unsigned levels = 4;
+		static constexpr std::uint64_t slots = 1 << bits;
+		static constexpr std::uint64_t mask = slots - 1;
+		static constexpr std::uint64_t horizon = (std::uint64_t(1) << (bits * levels)) - 1;
+
+		struct timer {
+			std::uint64_t deadline;
+			Payload payload;
+		};
+
+		std::vector<timer> buckets[levels][slots];
+		std::uint64_t current;
+		std::size_t pending;
+
+		void insert(timer&&);
+		std::uint64_t cascade(unsigned);
+	};
+}
+
+using timers::wheel;
+
+template<typename Payload>
+wheel<Payload>::wheel(std::uint64_t tick): current(tick), pending(0) { }
+
+template<typename Payload>
+void wheel<Payload>::schedule(const Payload& payload, std::uint64_t deadline) {
+	insert(timer{deadline < current ? current : deadline, payload});
+	++pending;
+}
+
+template<typename Payload>
+void wheel<Payload>::insert(timer&& entry) {
+	// Timers beyond the horizon wait on the last wheel and are cascaded there again until due.
+	std::uint64_t delta = std::min(entry.deadline - current, horizon);
+	std::uint64_t due = current + delta;
+	unsigned level = 0;
+	while (level + 1 < levels && delta >= (std::uint64_t(1) << (bits * (level + 1)))) {
+		++level;
+	}
+	buckets[level][(due >> (bits * level)) & mask].push_back(std::move(entry));
+}
+
+template<typename Payload>
+std::uint64_t wheel<Payload>::cascade(unsigned level) {
+	std::uint64_t index = (current >> (bits * level)) & mask;
+	std::vector<timer> bucket;
+	bucket.swap(buckets[level][index]);
+	for (auto& entry: bucket) {
+		insert(std::move(entry));
+	}
+	return index;
+}
+
+template<typename Payload>
+void wheel<Payload>::advance(std::uint64_t tick, const callback& expire) {
+	while (current <= tick) {
+		if (!pending) {
+			current = tick + 1;
+			break;
+		}
+
+		std::uint64_t index = current & mask;
+		for (unsigned level = 1; !index && level < levels; ++level) {
+			index = cascade(level);
+		}
+
+		std::vector<timer> bucket;
+		bucket.swap(buckets[0][current & mask]);
+		pending -= bucket.size();
+		++current;
+		for (auto& entry: bucket) {
+			expire(entry.payload);
+		}
+	}
+}
+
+template<typename Payload>
+inline std::size_t wheel<Payload>::size() { return pending; }
+
+#endif // TIMERS_WHEEL_HEADER
@@ -0,0 +1,60 @@
+#ifndef TRACE_EVENT_HEADER
+#define TRACE_EVENT_HEADER
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace trace {
+	/**
+	 *  Result of a request as it was seen by the main loop.
+	 */
+	enum outcome: std::uint8_t {
+		SUCCESS = 0,
+		FAILURE = 1
+	};
+
+	/**
+	 *  A single recorded request. Timestamps are nanoseconds since the recording started and the
+	 *  duration is the time the request took to be served.
+	 */
+	struct event {
+		std::uint64_t timestamp;
+		std::uint64_t duration;
+		outcome result;
+		std::string command;
+	};
+
+	/**
+	 *  Trace files start with a magic word and a format version, then a sequence of records. Each
+	 *  record holds unsigned LEB128 integers for the time elapsed since the previous record, the
+	 *  duration and the command length, followed by a byte for the outcome and the raw command.
+	 */
+	const std::string magic("WHTR");
+	const std::uint8_t version = 1;
+
+	void write_varint(std::ostream&, std::uint64_t);
+	bool read_varint(std::istream&, std::uint64_t&);
+}
+
+void trace::write_varint(std::ostream& output, std::uint64_t value) {
+	while (value >= 0x80) {
+		output.put(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	output.put(static_cast<char>(value));
+}
+
+bool trace::read_varint(std::istream& input, std::uint64_t& value) {
+	value = 0;
+	for (unsigned shift = 0; shift < 64; shift += 7) {
+		int byte = input.get();
+		if (byte == std::char_traits<char>::eof()) return false;
+		value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	throw std::runtime_error("Malformed trace file!");
+}
+
+#endif // TRACE_EVENT_HEADER
@@ -0,0 +1,67 @@
+#ifndef TRACE_RECORDER_HEADER
+#define TRACE_RECORDER_HEADER
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "trace/event.hpp"
+
+namespace trace {
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 *  Writes the requests received by the application to a compact binary trace file, so they can
+	 *  be replayed later with the same timing.
+	 */
+	class recorder {
+	public:
+		recorder(const std::string&);
+		~recorder();
+		void record(const std::string&, clock::time_point, clock::time_point, outcome);
+		void flush();
+
+	private:
+		std::ofstream output;
+		clock::time_point epoch;
+		std::uint64_t previous;
+	};
+}
+
+using trace::recorder;
+
+recorder::recorder(const std::string& filename):
+	output(filename, std::ios::binary | std::ios::trunc),
+	epoch(trace::clock::now()), previous(0) {
+
+	if (!output) {
+		throw std::invalid_argument("Unable to open trace file '" + filename + "'.");
+	}
+	output.write(trace::magic.data(), trace::magic.size());
+	output.put(static_cast<char>(trace::version));
+}
+
+recorder::~recorder() { flush(); }
+
+void recorder::record(
+	const std::string& command,
+	trace::clock::time_point started,
+	trace::clock::time_point finished,
+	trace::outcome result
+) {
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+	std::uint64_t timestamp = duration_cast<nanoseconds>(started - epoch).count();
+	std::uint64_t duration = duration_cast<nanoseconds>(finished - started).count();
+	trace::write_varint(output, timestamp - previous);
+	trace::write_varint(output, duration);
+	trace::write_varint(output, command.size());
+	output.put(static_cast<char>(result));
+	output.write(command.data(), command.size());
+	previous = timestamp;
+}
+
+inline void recorder::flush() { output.flush(); }
+
+#endif // TRACE_RECORDER_HEADER
@@ -0,0 +1,162 @@
+#ifndef TRACE_REPLAYER_HEADER
+#define TRACE_REPLAYER_HEADER
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace/event.hpp"
+#include "trace/recorder.hpp"
+
+namespace trace {
+	/**
+	 *  Loads a trace file and feeds its requests back to a handler, either at the original pace,
+	 *  scaled by a speed factor, or as fast as possible (speed = 0), from one or more concurrent
+	 *  clients. The handler is not assumed to be thread-safe, so calls to it are serialised and the
+	 *  measured latency includes the time a client waits for its turn.
+	 */
+	class replayer {
+	public:
+		typedef std::function<void(const std::string&)> handler;
+
+		replayer(const std::string&);
+		std::size_t size();
+		void run(const handler&, double, unsigned);
+		void report(std::ostream&);
+
+	private:
+		std::vector<event> events;
+		std::vector<std::uint64_t> latencies;
+		std::atomic<std::size_t> failures;
+		std::atomic<std::size_t> divergences;
+		std::uint64_t elapsed;
+		unsigned clients;
+
+		void load(std::istream&);
+		void serve(const handler&, double, unsigned, clock::time_point, std::mutex&);
+		std::uint64_t percentile(double);
+	};
+}
+
+using trace::replayer;
+
+replayer::replayer(const std::string& filename):
+	failures(0), divergences(0), elapsed(0), clients(0) {
+
+	std::ifstream input(filename, std::ios::binary);
+	if (!input) {
+		throw std::invalid_argument("Unable to open trace file '" + filename + "'.");
+	}
+	load(input);
+}
+
+void replayer::load(std::istream& input) {
+	std::string header(trace::magic.size(), '\0');
+	input.read(&header[0], header.size());
+	if (header != trace::magic || input.get() != trace::version) {
+		throw std::runtime_error("Unsupported trace file!");
+	}
+
+	std::uint64_t timestamp = 0, delta, length;
+	event current;
+	while (trace::read_varint(input, delta)) {
+		timestamp += delta;
+		int result;
+		if (!trace::read_varint(input, current.duration) || !trace::read_varint(input, length)
+			|| (result = input.get()) == std::char_traits<char>::eof()) {
+			throw std::runtime_error("Truncated trace file!");
+		}
+		current.timestamp = timestamp;
+		current.result = static_cast<trace::outcome>(result);
+		current.command.resize(length);
+		if (!input.read(&current.command[0], length)) {
+			throw std::runtime_error("Truncated trace file!");
+		}
+		events.push_back(current);
+	}
+}
+
+inline std::size_t replayer::size() { return events.size(); }
+
+void replayer::run(const handler& execute, double speed, unsigned clients) {
+	this->clients = std::max(clients, 1u);
+	latencies.assign(events.size(), 0);
+	failures = divergences = 0;
+
+	std::mutex turn;
+	std::vector<std::thread> pool;
+	trace::clock::time_point started = trace::clock::now();
+	for (unsigned client = 0; client < this->clients; ++client) {
+		pool.emplace_back(&replayer::serve, this, std::cref(execute), speed, client, started, std::ref(turn));
+	}
+	for (auto& thread: pool) {
+		thread.join();
+	}
+	elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(trace::clock::now() - started).count();
+}
+
+void replayer::serve(
+	const handler& execute, double speed, unsigned client,
+	trace::clock::time_point started, std::mutex& turn
+) {
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+	for (std::size_t index = client; index < events.size(); index += clients) {
+		const event& request = events[index];
+		if (speed > 0) {
+			std::this_thread::sleep_until(started + nanoseconds(
+				static_cast<std::uint64_t>(request.timestamp / speed)
+			));
+		}
+
+		trace::clock::time_point issued = trace::clock::now();
+		trace::outcome result = trace::SUCCESS;
+		{
+			std::lock_guard<std::mutex> lock(turn);
+			try {
+				execute(request.command);
+			} catch(const std::exception&) {
+				result = trace::FAILURE;
+			}
+		}
+		latencies[index] = duration_cast<nanoseconds>(trace::clock::now() - issued).count();
+
+		if (result == trace::FAILURE) ++failures;
+		if (result != request.result) ++divergences;
+	}
+}
+
+std::uint64_t replayer::percentile(double rank) {
+	if (latencies.empty()) return 0;
+	std::size_t position = static_cast<std::size_t>(rank * (latencies.size() - 1));
+	return latencies[position];
+}
+
+void replayer::report(std::ostream& output) {
+	std::sort(latencies.begin(), latencies.end());
+	double seconds = elapsed / 1e9;
+	auto micros = [](std::uint64_t nanoseconds) { return nanoseconds / 1e3; };
+	output << std::fixed << std::setprecision(2)
+		<< "Requests: " << events.size() << " from " << clients << " client(s)\n"
+		<< "Failures: " << failures << " (" << divergences << " differ from the trace)\n"
+		<< "Elapsed: " << seconds << " s\n"
+		<< "Throughput: " << (seconds > 0 ? events.size() / seconds : 0) << " requests/s\n"
+		<< "Latency (us): "
+		<< "p50=" << micros(percentile(0.50)) << ", "
+		<< "p90=" << micros(percentile(0.90)) << ", "
+		<< "p99=" << micros(percentile(0.99)) << ", "
+		<< "p99.9=" << micros(percentile(0.999)) << ", "
+		<< "max=" << micros(percentile(1.0))
+	<< std::endl;
+}
+
+#endif // TRACE_REPLAYER_HEADER
@@ -0,0 +1,70 @@
+#include <utz.hpp>
+#include <controllers/warehouse.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+typedef void (controllers::warehouse::*request)(std::stringstream&);
+
+// Sends a request to the warehouse and gives back what it puts in the standard output.
+std::string call(controllers::warehouse& warehouse, request method, const std::string& arguments) {
+	std::stringstream command_line(arguments);
+	std::stringstream output;
+	auto old_output_buffer = std::cout.rdbuf(output.rdbuf());
+	try {
+		(warehouse.*method)(command_line);
+	} catch(...) {
+		std::cout.rdbuf(old_output_buffer);
+		throw;
+	}
+	std::cout.rdbuf(old_output_buffer);
+	return output.str();
+}
+
+void utz::test() {
+	utz::log << "Test cases for holds." << std::endl;
+	controllers::warehouse::settings fixture;
+	fixture.inventory = "../utz/data/inventory";   // Legs (1), screws (2) and seats (3).
+	fixture.catalog = "../utz/data/assemblies";    // Leg Pair, and Dinning Chair made from two of them.
+	controllers::warehouse warehouse(fixture);
+
+	"warehouse::hold gives back the ID of the hold."
+		| expect(call(warehouse, &controllers::warehouse::hold, "Dinning Chair 100"), is::equal, std::string("Hold 1: 'Dinning Chair' for 100 seconds.\n"));
+
+	"Held product takes its articles out of the stock."
+		| expect(call(warehouse, &controllers::warehouse::list, ""), is::equal, std::string("Dinning Chair: 1\nLeg Pair: 4\n"));
+
+	call(warehouse, &controllers::warehouse::release, "1");
+	"Released hold puts its articles back in the stock."
+		| expect(call(warehouse, &controllers::warehouse::list, ""), is::equal, std::string("Dinning Chair: 2\nLeg Pair: 6\n"));
+
+	call(warehouse, &controllers::warehouse::hold, "Dinning Chair 100");
+	call(warehouse, &controllers::warehouse::confirm, "2");
+	"Confirmed hold keeps its articles out of the stock."
+		| expect(call(warehouse, &controllers::warehouse::list, ""), is::equal, std::string("Dinning Chair: 1\nLeg Pair: 4\n"));
+
+	bool refused = false;
+	try {
+		call(warehouse, &controllers::warehouse::release, "2");
+	} catch(const std::invalid_argument&) {
+		refused = true;
+	}
+	"Confirmed hold can't be released."
+		| expect(refused, is::equal, true);
+
+	utz::log << "Cheking that holds expire after their time to live, not before." << std::endl;
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	call(warehouse, &controllers::warehouse::hold, "Leg Pair 1");
+	std::this_thread::sleep_for(std::chrono::milliseconds(800));
+	"Hold is kept until its time to live is over, even across a second boundary."
+		| expect(call(warehouse, &controllers::warehouse::list, ""), is::equal, std::string("Dinning Chair: 0\nLeg Pair: 3\n"));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+	"Expired hold puts its articles back in the stock."
+		| expect(call(warehouse, &controllers::warehouse::list, ""), is::equal, std::string("Dinning Chair: 1\nLeg Pair: 4\n"));
+
+	utz::log << "End of test cases for holds." << std::endl;
+}
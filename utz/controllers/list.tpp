@@ -0,0 +1,104 @@
+#include <utz.hpp>
+#include <controllers/warehouse.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Sends a list request to the warehouse and gives back what it puts in the standard output.
+std::string list(controllers::warehouse& warehouse, const std::string& arguments) {
+	std::stringstream command_line(arguments);
+	std::stringstream output;
+	auto old_output_buffer = std::cout.rdbuf(output.rdbuf());
+	try {
+		warehouse.list(command_line);
+	} catch(...) {
+		std::cout.rdbuf(old_output_buffer);
+		throw;
+	}
+	std::cout.rdbuf(old_output_buffer);
+	return output.str();
+}
+
+// Follows the cursors page after page and gives back the names of the products found.
+std::string walk(controllers::warehouse& warehouse, const std::string& arguments) {
+	std::string names;
+	std::string cursor;
+	do {
+		std::stringstream page(list(warehouse, arguments + (cursor.empty() ? "" : " after \"" + cursor + "\"")));
+		std::string line;
+		cursor.clear();
+		while (std::getline(page, line)) {
+			if (line.rfind("-- after ", 0) == 0) {
+				std::stringstream(line.substr(9)) >> std::quoted(cursor);
+			} else {
+				names += line.substr(0, line.find(':')) + ' ';
+			}
+		}
+	} while (!cursor.empty());
+	return names;
+}
+
+void utz::test() {
+	utz::log << "Test cases for list." << std::endl;
+	controllers::warehouse::settings fixture;
+	fixture.inventory = "../utz/data/inventory";   // Legs (1), screws (2) and seats (3).
+	fixture.catalog = "../utz/data/furniture";     // Bench 3, Chair 2, Shelf 8, Stool 4, Table 3 and Tray 0.
+	controllers::warehouse warehouse(fixture);
+
+	utz::log << "Cheking the listing by name." << std::endl;
+	"list shows every product by name."
+		| expect(list(warehouse, ""), is::equal, std::string("Bench: 3\nChair: 2\nShelf: 8\nStool: 4\nTable: 3\nTray: 0\n"));
+
+	"list shows the available products below an availability."
+		| expect(list(warehouse, "available below 4"), is::equal, std::string("Bench: 3\nChair: 2\nTable: 3\n"));
+
+	"list shows the cursor of the next page after a full page."
+		| expect(list(warehouse, "limit 2"), is::equal, std::string("Bench: 3\nChair: 2\n-- after \"Chair\"\n"));
+
+	"list starts after the cursor."
+		| expect(list(warehouse, "limit 2 after Chair"), is::equal, std::string("Shelf: 8\nStool: 4\n-- after \"Stool\"\n"));
+
+	"list doesn't show a cursor after the last page if it's not full."
+		| expect(list(warehouse, "limit 4 after Stool"), is::equal, std::string("Table: 3\nTray: 0\n"));
+
+	"list with a prefix starts after a cursor within the prefix."
+		| expect(list(warehouse, "prefix S after Shelf"), is::equal, std::string("Stool: 4\n"));
+
+	"list with a prefix starts on the prefix if the cursor comes before it."
+		| expect(list(warehouse, "prefix T after Bench"), is::equal, std::string("Table: 3\nTray: 0\n"));
+
+	"list walks every product once by name."
+		| expect(walk(warehouse, "limit 4"), is::equal, std::string("Bench Chair Shelf Stool Table Tray "));
+
+	utz::log << "Cheking the listing by availability." << std::endl;
+	"list by availability breaks ties by name."
+		| expect(list(warehouse, "by availability"), is::equal, std::string("Tray: 0\nChair: 2\nBench: 3\nTable: 3\nStool: 4\nShelf: 8\n"));
+
+	"list by availability shows the availability and the name of the last product as cursor."
+		| expect(list(warehouse, "by availability limit 3"), is::equal, std::string("Tray: 0\nChair: 2\nBench: 3\n-- after \"3:Bench\"\n"));
+
+	"list by availability starts after the cursor, even between ties."
+		| expect(list(warehouse, "by availability limit 3 after 3:Bench"), is::equal, std::string("Table: 3\nStool: 4\nShelf: 8\n-- after \"8:Shelf\"\n"));
+
+	"list by availability shows nothing after the last product."
+		| expect(list(warehouse, "by availability limit 3 after 8:Shelf"), is::equal, std::string(""));
+
+	"list by availability in descending order starts after the cursor."
+		| expect(list(warehouse, "by availability desc limit 2 after 4:Stool"), is::equal, std::string("Bench: 3\nTable: 3\n-- after \"3:Table\"\n"));
+
+	"list walks every product once by availability in two pages."
+		| expect(walk(warehouse, "by availability limit 3"), is::equal, std::string("Tray Chair Bench Table Stool Shelf "));
+
+	"list walks every product once by availability in smaller pages."
+		| expect(walk(warehouse, "by availability limit 2"), is::equal, std::string("Tray Chair Bench Table Stool Shelf "));
+
+	"list walks every product once by availability in descending order."
+		| expect(walk(warehouse, "by availability desc limit 2"), is::equal, std::string("Shelf Stool Bench Table Chair Tray "));
+
+	"list walks the products with a prefix once by availability."
+		| expect(walk(warehouse, "prefix S by availability limit 1"), is::equal, std::string("Stool Shelf "));
+
+	utz::log << "End of test cases for list." << std::endl;
+}
@@ -37,5 +37,9 @@ void utz::test() {
 	"main call success (result == EXIT_SUCCESS)."
 		| expect(result, is::equal, EXIT_SUCCESS);
 
+	const char* unnamed_shared_arguments[] = {"application", "--shared"};
+	"main call fails when the shared inventory has no name (result == EXIT_FAILURE)."
+		| expect(__real_main(2, unnamed_shared_arguments), is::equal, EXIT_FAILURE);
+
 	utz::log << "All test cases have finished!" << std::endl;
 }
@@ -46,5 +46,15 @@ void utz::test() {
 	"field::set writes the correct internal value to JSON node using the custom setter."
 		| expect(object["custom"].GetInt(), is::equal, 7);
 
+	utz::log << "Test copies of fields with default getters and setters:" << std::endl;
+	models::field<int> copied_integer(parsed_integer);
+	object["parsed"] = "9";
+	copied_integer.get(object);
+	"field::get on a copy reads the value into the copy."
+		| expect((int)copied_integer, is::equal, 9);
+
+	"field::get on a copy doesn't change the value of the original field."
+		| expect((int)parsed_integer, is::equal, 4);
+
 	utz::log << "End of test cases for field." << std::endl;
 }
\ No newline at end of file
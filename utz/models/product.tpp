@@ -0,0 +1,97 @@
+#include <utz.hpp>
+#include <models/product.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+bool rejects(models::article& inventory, const std::string& source) {
+	try {
+		models::product catalog(&inventory, source);
+	} catch(const std::invalid_argument& error) {
+		utz::log << "Rejected: " << error.what() << std::endl;
+		return true;
+	}
+	return false;
+}
+
+// The catalog being reloaded lives under out/, so the fixtures are copied over it.
+void copy(const std::string& from, const std::string& to) {
+	std::ifstream input(from);
+	std::ofstream output(to);
+	output << input.rdbuf();
+}
+
+void utz::test() {
+	utz::log << "Test cases for product." << std::endl;
+	models::article inventory("../utz/data/inventory"); // Legs (1), screws (2) and seats (3).
+
+	utz::log << "Cheking the bill of a product made from a sub-assembly." << std::endl;
+	models::product catalog(&inventory, "../utz/data/assemblies");
+	catalog.read("Dinning Chair");
+	list_of_articles bill = catalog.get_bill();
+	"Bill has every article of the product and of its components."
+		| expect((int)bill.size(), is::equal, 3);
+
+	"Articles of a component are multiplied by the amount of the component."
+		| expect(bill[1], is::equal, 4);
+
+	"Article listed directly and through a component is summed up."
+		| expect(bill[2], is::equal, 8);
+
+	"Article listed only directly keeps its amount."
+		| expect(bill[3], is::equal, 1);
+
+	"Availability is computed from the bill."
+		| expect(catalog.get_availability(), is::equal, 2);
+
+	utz::log << "Cheking that invalid catalogs are rejected." << std::endl;
+	"Product made from itself through a component is rejected."
+		| expect(rejects(inventory, "../utz/data/cycle"), is::equal, true);
+
+	"Product made from an unknown component is rejected."
+		| expect(rejects(inventory, "../utz/data/missing"), is::equal, true);
+
+	utz::log << "Cheking that the catalog is reloaded from the file." << std::endl;
+	copy("utz/data/assemblies.json", "out/catalog.json");
+	models::product reloaded(&inventory, "../out/catalog");
+	copy("utz/data/reloaded.json", "out/catalog.json");
+	models::product::changes changes = reloaded.reload();
+	"product::reload finds the products added, removed and changed."
+		| expect(changes.added.count("Stool") && changes.removed.count("Leg Pair") && changes.changed.count("Dinning Chair"), is::equal, true);
+
+	"product::reload finds nothing else."
+		| expect(changes.added.size() + changes.removed.size() + changes.changed.size(), is::equal, (std::size_t)3);
+
+	"Removed product is gone with its availability."
+		| expect(reloaded.exists("Leg Pair") || reloaded.get_availabilities().count("Leg Pair"), is::equal, false);
+
+	reloaded.read("Stool");
+	"Added product gets its availability."
+		| expect(reloaded.get_availability(), is::equal, 2);
+
+	reloaded.read("Dinning Chair");
+	bill = reloaded.get_bill();
+	"Changed product gets its new bill."
+		| expect(bill.size() == 3 && bill[1] == 4 && bill[2] == 8 && bill[3] == 1, is::equal, true);
+
+	copy("utz/data/broken.json", "out/catalog.json");
+	bool refused = false;
+	try {
+		reloaded.reload();
+	} catch(const std::invalid_argument& error) {
+		utz::log << "Rejected: " << error.what() << std::endl;
+		refused = true;
+	}
+	"product::reload rejects an amount which is not a number."
+		| expect(refused, is::equal, true);
+
+	"Rejected reload leaves the availabilities unchanged."
+		| expect(reloaded.get_availabilities().at("Dinning Chair") == 2 && reloaded.get_availabilities().at("Stool") == 2, is::equal, true);
+
+	reloaded.read("Dinning Chair");
+	"Rejected reload leaves the bills unchanged."
+		| expect(reloaded.get_bill()[2], is::equal, 8);
+
+	utz::log << "End of test cases for product." << std::endl;
+}
@@ -0,0 +1,109 @@
+#include <utz.hpp>
+#include <models/shared_inventory.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Class to test the recovery, since an update is only left half way when its process dies.
+class crashing_inventory: public models::shared_inventory {
+public:
+	using shared_inventory::shared_inventory;
+
+	// The thread finishes holding the lock, so the next one to take it finds its owner dead.
+	void crash_while_taking(int article_id, int amount) {
+		std::thread([this, article_id, amount]() {
+			pthread_mutex_lock(&info->lock);
+			std::uint32_t index = article_index.at(article_id);
+			journal[0] = {index, stocks[index].stock};
+			open_journal(1, none);
+			stocks[index].stock -= amount;
+		}).join();
+	}
+};
+
+bool refuses(const std::string& name, models::article& inventory, models::product& catalog) {
+	try {
+		models::shared_inventory attached(name, &inventory, &catalog, 2);
+	} catch(const std::runtime_error& error) {
+		utz::log << "Refused: " << error.what() << std::endl;
+		return true;
+	}
+	return false;
+}
+
+void utz::test() {
+	utz::log << "Test cases for shared inventory." << std::endl;
+	const std::string name("/warehouse-utz-" + std::to_string(getpid()));
+	models::article inventory("../utz/data/inventory"); // Legs (1), screws (2) and seats (3).
+	models::product catalog(&inventory, "../utz/data/assemblies");
+	shm_unlink(name.c_str());
+
+	crashing_inventory one(name, &inventory, &catalog, 2);
+	models::shared_inventory two(name, &inventory, &catalog, 2);
+
+	utz::log << "Cheking that processes share the stock." << std::endl;
+	catalog.read("Dinning Chair");
+	"shared_inventory::adjust takes the bill out of the stock."
+		| expect(one.adjust(catalog.get_bill(), -1), is::equal, true);
+
+	"Sale through one process changes the stock of the other."
+		| expect(two.get_stock(2), is::equal, 9);
+
+	"Sale through one process changes the availability of the other."
+		| expect(two.get_availabilities().at("Dinning Chair") == 1 && two.get_availabilities().at("Leg Pair") == 4, is::equal, true);
+
+	models::product furniture(&inventory, "../utz/data/furniture");
+	"Segment made from a different catalog is refused."
+		| expect(refuses(name, inventory, furniture), is::equal, true);
+
+	utz::log << "Cheking the holds recorded in the segment." << std::endl;
+	int first = two.hold("Leg Pair");
+	int second = one.hold("Leg Pair");
+	"shared_inventory::hold takes the bill out of the stock."
+		| expect(first >= 0 && second >= 0 && one.get_stock(1) == 4, is::equal, true);
+
+	bool full = false;
+	try {
+		two.hold("Leg Pair");
+	} catch(const std::runtime_error&) {
+		full = true;
+	}
+	"shared_inventory::hold is refused when the table of holds is full."
+		| expect(full, is::equal, true);
+
+	two.release(first);
+	one.confirm(second);
+	"Released hold puts its bill back in the stock, confirmed one doesn't."
+		| expect(two.get_stock(1), is::equal, 6);
+
+	int reused = two.hold("Leg Pair");
+	"Slots of released and confirmed holds are used again."
+		| expect(reused >= 0 && one.hold("Leg Pair") >= 0, is::equal, true);
+
+	utz::log << "Cheking the recovery of a process which died." << std::endl;
+	one.crash_while_taking(3, 1);
+	two.release(reused);
+	"Interrupted update is rolled back by the next one to take the lock."
+		| expect(two.get_stock(3), is::equal, 1);
+
+	pid_t child = fork();
+	if (!child) {
+		models::shared_inventory orphan(name, &inventory, &catalog, 2);
+		orphan.hold("Leg Pair");
+		_exit(EXIT_SUCCESS);
+	}
+	waitpid(child, NULL, 0);
+	int before = one.get_stock(1);
+	models::shared_inventory three(name, &inventory, &catalog, 2);
+	"Holds of a finished process are released when another one attaches."
+		| expect(three.get_stock(1), is::equal, before + 2);
+
+	shm_unlink(name.c_str());
+	utz::log << "End of test cases for shared inventory." << std::endl;
+}
@@ -0,0 +1,95 @@
+#include <utz.hpp>
+#include <simulation/simulator.hpp>
+#include <controllers/warehouse.hpp>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef void (controllers::warehouse::*request)(std::stringstream&);
+
+// Sends a request to the warehouse and gives back what it puts in the standard output.
+std::string call(controllers::warehouse& warehouse, request method, const std::string& arguments) {
+	std::stringstream command_line(arguments);
+	std::stringstream output;
+	auto old_output_buffer = std::cout.rdbuf(output.rdbuf());
+	try {
+		(warehouse.*method)(command_line);
+	} catch(...) {
+		std::cout.rdbuf(old_output_buffer);
+		throw;
+	}
+	std::cout.rdbuf(old_output_buffer);
+	return output.str();
+}
+
+int availability(controllers::warehouse& warehouse, const std::string& name) {
+	std::string line = call(warehouse, &controllers::warehouse::list, "prefix \"" + name + "\" limit 1");
+	return std::stoi(line.substr(line.find(':') + 1));
+}
+
+std::string report(simulation::simulator& simulator) {
+	std::stringstream output;
+	simulator.report(output);
+	return output.str();
+}
+
+void utz::test() {
+	utz::log << "Test cases for simulator." << std::endl;
+	// Chairs take one leg, tables two legs and a top. There are 4 legs and 1 top.
+	simulation::simulator simulator({"Chair", "Table"}, {{{1, 1}}, {{1, 2}, {2, 1}}}, {{1, 4}, {2, 1}}, {4, 1});
+	simulation::simulator::settings settings;
+	settings.scenarios = 10;
+	settings.orders = 6;
+	settings.mix["Chair"] = 1;
+	simulator.run(settings);
+	"simulator reports fill rate and stockouts, also of the products which run out through shared articles."
+		| expect(report(simulator), is::equal, std::string(
+			"Chair: fill rate 66.67%, out of stock in 100.00% of scenarios, after 4.00 orders on average\n"
+			"Table: fill rate 100.00%, out of stock in 100.00% of scenarios, after 3.00 orders on average\n"
+		));
+
+	settings.scenarios = 200;
+	settings.orders = 5;
+	settings.seed = 42;
+	settings.mix.clear();
+	settings.threads = 1;
+	simulator.run(settings);
+	std::string sequential = report(simulator);
+	settings.threads = 4;
+	simulator.run(settings);
+	"simulator gives the same report for the same seed whatever the number of threads."
+		| expect(report(simulator), is::equal, sequential);
+
+	utz::log << "Cheking that simulated orders follow the same rules as selling." << std::endl;
+	controllers::warehouse::settings fixture;
+	fixture.inventory = "../utz/data/inventory";   // Legs (1), screws (2) and seats (3).
+	fixture.catalog = "../utz/data/assemblies";    // Leg Pair, and Dinning Chair made from two of them.
+	controllers::warehouse warehouse(fixture);
+	std::string simulated = call(warehouse, &controllers::warehouse::simulate, "scenarios 1 orders 5 mix \"Dinning Chair\" 1");
+
+	std::map<std::string, int> out_of_stock;
+	int sold = 0;
+	for (int order = 1; order <= 5; ++order) {
+		try {
+			call(warehouse, &controllers::warehouse::sell, "Dinning Chair");
+			sold++;
+		} catch(const std::invalid_argument&) { }
+		for (const std::string name: {"Dinning Chair", "Leg Pair"}) {
+			if (!out_of_stock.count(name) && availability(warehouse, name) <= 0) out_of_stock[name] = order;
+		}
+	}
+	std::stringstream expected;
+	expected << std::fixed << std::setprecision(2)
+		<< "Dinning Chair: fill rate " << 100.0 * sold / 5 << "%, out of stock in 100.00% of scenarios, "
+		<< "after " << (double)out_of_stock["Dinning Chair"] << " orders on average\n"
+		<< "Leg Pair: fill rate 100.00%, out of stock in 100.00% of scenarios, "
+		<< "after " << (double)out_of_stock["Leg Pair"] << " orders on average\n";
+	"simulator sells and runs out of stock as selling does."
+		| expect(simulated, is::equal, expected.str());
+
+	utz::log << "End of test cases for simulator." << std::endl;
+}
@@ -0,0 +1,28 @@
+#include <utz.hpp>
+#include <simulation/snapshot.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+void utz::test() {
+	utz::log << "Test cases for copy-on-write snapshot." << std::endl;
+	std::vector<int> values;
+	for (int value = 0; value < 10; ++value) values.push_back(value);
+	simulation::snapshot<int, 4> original(values);
+
+	"snapshot keeps every value of the vector it was made from."
+		| expect(original.size() == 10 && original.get(0) == 0 && original.get(9) == 9, is::equal, true);
+
+	simulation::snapshot<int, 4> copy(original);
+	copy.set(5, 50);
+	"snapshot::set changes the value on the copy."
+		| expect(copy.get(5), is::equal, 50);
+
+	"snapshot::set doesn't change the value on the original."
+		| expect(original.get(5), is::equal, 5);
+
+	"snapshot::set keeps the other values of the copied page."
+		| expect(copy.get(4) == 4 && copy.get(6) == 6 && copy.get(7) == 7, is::equal, true);
+
+	utz::log << "End of test cases for copy-on-write snapshot." << std::endl;
+}
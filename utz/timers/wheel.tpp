@@ -0,0 +1,42 @@
+#include <utz.hpp>
+#include <timers/wheel.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+void utz::test() {
+	utz::log << "Test cases for timer wheel." << std::endl;
+	timers::wheel<int> wheel;
+	std::vector<int> expired;
+	auto collect = [&expired](const int& payload) { expired.push_back(payload); };
+
+	wheel.schedule(1, 10);
+	wheel.schedule(2, 100);     // Second wheel.
+	wheel.schedule(3, 10000);   // Third wheel.
+	"wheel::size counts every scheduled timer."
+		| expect(wheel.size(), is::equal, (std::size_t)3);
+
+	wheel.advance(9, collect);
+	"wheel::advance doesn't expire timers before their deadline."
+		| expect(expired.size(), is::equal, (std::size_t)0);
+
+	wheel.advance(10, collect);
+	"wheel::advance expires a timer on its deadline."
+		| expect(expired.size() == 1 && expired[0] == 1, is::equal, true);
+
+	wheel.advance(99, collect);
+	wheel.advance(100, collect);
+	"wheel::advance expires timers cascaded from the second wheel on their deadline."
+		| expect(expired.size() == 2 && expired[1] == 2, is::equal, true);
+
+	wheel.advance(9999, collect);
+	"wheel::advance doesn't expire timers cascaded from the third wheel before their deadline."
+		| expect(expired.size(), is::equal, (std::size_t)2);
+
+	wheel.schedule(4, 5);       // Deadline in the past.
+	wheel.advance(10000, collect);
+	"wheel::advance expires overdue and cascaded timers."
+		| expect(expired.size() == 4 && wheel.size() == 0, is::equal, true);
+
+	utz::log << "End of test cases for timer wheel." << std::endl;
+}
@@ -0,0 +1,41 @@
+#include <utz.hpp>
+#include <trace/recorder.hpp>
+#include <trace/replayer.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+void utz::test() {
+	utz::log << "Test cases for trace recorder and replayer." << std::endl;
+	const std::string filename("out/recorder.trace");
+	{
+		trace::recorder recorder(filename);
+		trace::clock::time_point now = trace::clock::now();
+		recorder.record("sell Dinning Chair", now, now + std::chrono::microseconds(5), trace::SUCCESS);
+		recorder.record("sell Nothing", now + std::chrono::milliseconds(1), now + std::chrono::milliseconds(2), trace::FAILURE);
+		recorder.record("list", now + std::chrono::milliseconds(3), now + std::chrono::milliseconds(4), trace::SUCCESS);
+	}
+
+	trace::replayer replayer(filename);
+	"replayer loads every request written by the recorder."
+		| expect(replayer.size(), is::equal, (std::size_t)3);
+
+	std::vector<std::string> received;
+	replayer.run([&received](const std::string& command) {
+		received.push_back(command);
+		if (command == "sell Nothing") throw std::invalid_argument("Product doesn't exists!");
+	}, 0, 1);
+	"replayer feeds the requests back in their original order."
+		| expect(received.size() == 3 && received[1] == "sell Nothing" && received[2] == "list", is::equal, true);
+
+	std::stringstream report;
+	replayer.report(report);
+	"replayer reports the failed requests and that they match the trace."
+		| expect(report.str().find("Failures: 1 (0 differ from the trace)") != std::string::npos, is::equal, true);
+
+	utz::log << "End of test cases for trace recorder and replayer." << std::endl;
+}